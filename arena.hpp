@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_ARENA_HPP
+#define UNT_ARENA_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// per-thread bump arena for the scratch of a solve: the falsification table,
+// the universe, the limbs of the search and the phi tables. blocks are cut from
+// one chunk in order and a release only counts them; once every block of an
+// arena is released, its next allocation rewinds it in O(1). a batch worker so
+// reuses the same chunk from one instance to the next and never reaches the
+// heap once it has seen its largest instance.
+//
+// a block may be released on another thread (a k-ary lane, an OpenMP worker):
+// its header names the arena it came from. chunks outgrown in the middle of a
+// solve are kept until the rewind, which folds them into one. blocks past
+// arena_direct bytes, a table of many variables, go to the heap directly, and
+// so does all of a heap_scope: state that outlives the solves around it (the
+// formula of --edits) would hold its arena from ever rewinding.
+
+constexpr std::size_t arena_direct = std::size_t(64) << 20;
+
+class arena {
+public:
+    // the arena of the calling thread
+    static arena &local() {
+        static thread_local holder h;
+        return *h.a;
+    }
+
+    // while one is open, the blocks of its thread go to the heap;
+    // heap_scope(false) puts the arena back within it
+    class heap_scope {
+    public:
+        explicit heap_scope(bool heap = true) : prior(local().heap) { local().heap = heap; }
+
+        heap_scope(const heap_scope &) = delete;
+
+        heap_scope &operator=(const heap_scope &) = delete;
+
+        ~heap_scope() { local().heap = prior; }
+
+    private:
+        bool prior;
+    };
+
+    void *allocate(std::size_t bytes) {
+        const auto need(sizeof(header) + (bytes + 15) / 16 * 16);
+        if (need > arena_direct || heap) {
+            auto h(static_cast<header *>(::operator new(need)));
+            h->owner = nullptr;
+            return h + 1;
+        }
+        if (!live.load(std::memory_order_acquire)) {
+            rewind();
+        }
+        if (used + need > size) {
+            grow(need);
+        }
+        auto h(reinterpret_cast<header *>(base + used));
+        used += need;
+        h->owner = this;
+        live.fetch_add(1, std::memory_order_relaxed);
+        return h + 1;
+    }
+
+    static void release(void *p) {
+        auto h(static_cast<header *>(p) - 1);
+        if (h->owner) {
+            h->owner->live.fetch_sub(1, std::memory_order_release);
+        } else {
+            ::operator delete(h);
+        }
+    }
+
+    // bytes the arena holds
+    std::size_t reserved() const {
+        auto r(size);
+        for (const auto &c : spent) {
+            r += c.second;
+        }
+        return r;
+    }
+
+private:
+    struct alignas(16) header {
+        arena *owner;
+    };
+
+    // a thread that exits with blocks still out (handed to another thread)
+    // leaves its arena behind for them
+    struct holder {
+        holder() : a(new arena) {}
+
+        ~holder() {
+            if (!a->live.load(std::memory_order_acquire)) {
+                delete a;
+            }
+        }
+
+        arena *a;
+    };
+
+    arena() = default;
+
+    ~arena() {
+        for (const auto &c : spent) {
+            ::operator delete(c.first);
+        }
+        ::operator delete(base);
+    }
+
+    void rewind() {
+        if (!spent.empty()) {
+            const auto total(reserved());
+            for (const auto &c : spent) {
+                ::operator delete(c.first);
+            }
+            spent.clear();
+            ::operator delete(base);
+            base = static_cast<char *>(::operator new(total));
+            size = total;
+        }
+        used = 0;
+    }
+
+    void grow(std::size_t need) {
+        if (base) {
+            spent.emplace_back(base, size);
+        }
+        size = std::max({2 * size, need, std::size_t(1) << 16});
+        base = static_cast<char *>(::operator new(size));
+        used = 0;
+    }
+
+    char *base = nullptr;
+    std::size_t size = 0, used = 0;
+    std::vector<std::pair<char *, std::size_t>> spent;
+    std::atomic<std::size_t> live{0};
+    bool heap = false;
+};
+
+template<typename T>
+struct scratch_allocator {
+    using value_type = T;
+
+    scratch_allocator() = default;
+
+    template<typename U>
+    scratch_allocator(const scratch_allocator<U> &) {}
+
+    T *allocate(std::size_t k) { return static_cast<T *>(arena::local().allocate(k * sizeof(T))); }
+
+    void deallocate(T *p, std::size_t) { arena::release(p); }
+
+    template<typename U>
+    bool operator==(const scratch_allocator<U> &) const { return true; }
+
+    template<typename U>
+    bool operator!=(const scratch_allocator<U> &) const { return false; }
+};
+
+template<typename T>
+using scratch_vector = std::vector<T, scratch_allocator<T>>;
+
+#endif
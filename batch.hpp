@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_BATCH_HPP
+#define UNT_BATCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "dimacs.hpp"
+#include "pool.hpp"
+
+// batch inputs: a directory stands for its regular files in name order, a
+// list file (--list) for one path per line, anything else for itself
+inline void expand_directory(const std::string &path, std::vector<std::string> &paths) {
+    struct stat st{};
+    if (path == "-" || ::stat(path.c_str(), &st) || !S_ISDIR(st.st_mode)) {
+        paths.push_back(path);
+        return;
+    }
+    std::vector<std::string> files;
+    if (auto dir = ::opendir(path.c_str())) {
+        while (auto e = ::readdir(dir)) {
+            const auto file(path + "/" + e->d_name);
+            if (e->d_name[0] != '.' && !::stat(file.c_str(), &st) && S_ISREG(st.st_mode)) {
+                files.push_back(file);
+            }
+        }
+        ::closedir(dir);
+    }
+    std::sort(files.begin(), files.end());
+    paths.insert(paths.end(), files.begin(), files.end());
+}
+
+inline void read_list(const std::string &list, std::vector<std::string> &paths) {
+    const mapped_file file(list);
+    for (auto p(file.begin()); p != file.end();) {
+        const auto e(std::find(p, file.end(), '\n'));
+        auto b(p), t(e);
+        while (b != t && (*b == ' ' || *b == '\t')) {
+            b++;
+        }
+        while (t != b && (t[-1] == ' ' || t[-1] == '\t' || t[-1] == '\r')) {
+            t--;
+        }
+        if (b != t && *b != '#') {
+            expand_directory(std::string(b, t), paths);
+        }
+        p = e == file.end() ? e : e + 1;
+    }
+}
+
+struct batch_summary {
+    std::size_t instances = 0, failed = 0;
+    std::chrono::duration<double> elapsed{0};
+};
+
+// solve(path, scratch) for every path on a task_pool, each worker with its own
+// S scratch; scratch.take() hands over the text of the instance, which reaches
+// `out` right after that of instance k - 1, as soon as both are done. solve
+// returns false on failure.
+template<typename S, typename F>
+batch_summary run_batch(const std::vector<std::string> &paths, std::size_t threads, std::ostream &out, F &&solve) {
+    const auto start(std::chrono::steady_clock::now());
+    std::vector<std::string> text(paths.size());
+    std::vector<char> ready(paths.size(), 0), ok(paths.size(), 0);
+    std::mutex mutex;
+    std::condition_variable done;
+    batch_summary summary;
+    {
+        task_pool pool(threads);
+        std::vector<S> scratch(pool.size());
+        for (std::size_t k(0); k < paths.size(); k++) {
+            pool.submit([&, k](std::size_t worker) {
+                auto &s(scratch[worker]);
+                const bool r(solve(paths[k], s));
+                std::lock_guard<std::mutex> lock(mutex);
+                text[k] = s.take();
+                ok[k] = r;
+                ready[k] = 1;
+                done.notify_one();
+            });
+        }
+        for (std::size_t k(0); k < paths.size(); k++) {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&] { return ready[k]; });
+            const auto chunk(std::move(text[k]));
+            lock.unlock();
+            out << chunk;
+            summary.failed += !ok[k];
+        }
+        out.flush();
+        pool.wait();
+    }
+    summary.instances = paths.size();
+    summary.elapsed = std::chrono::steady_clock::now() - start;
+    return summary;
+}
+
+#endif
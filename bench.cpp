@@ -0,0 +1,293 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+// benchmark suite: seeded random k-CNF over a grid of (n, m, k) and random
+// subset-sum universes, each stage timed after a warmup over a number of
+// repetitions. each workload is generated from the seed and its name alone.
+// one CSV row per (workload, stage): the parameters, a result checksum (it
+// must not move between releases for the same seed, --quick or not) and the
+// min / median / mean / stddev / max in ns. --baseline compares the medians
+// against an earlier file and fails on any stage slower by more than
+// --threshold percent (medians under --floor are noise), or whose checksum
+// changed. subset-sum rows put the value width in bits in the n column.
+
+#define UNT_NO_MAIN
+
+#include "sat_equation_and_abstract_binary_search.cpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+struct summary {
+    double min, median, mean, stddev, max;
+};
+
+struct bench_row {
+    std::string workload, stage;
+    std::size_t n, m, k;
+    word result;
+    summary time;
+};
+
+// f() returns the checksum of one run; warmup runs are not timed
+template<typename F>
+std::pair<word, summary> measure(F &&f, std::size_t warmup, std::size_t reps) {
+    word result(0);
+    for (std::size_t r(0); r < warmup; r++) {
+        result = f();
+    }
+    std::vector<double> ns;
+    for (std::size_t r(0); r < reps; r++) {
+        const auto start(std::chrono::steady_clock::now());
+        result = f();
+        ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(ns.begin(), ns.end());
+    const auto mean(std::accumulate(ns.begin(), ns.end(), 0.0) / ns.size());
+    double var(0);
+    for (const auto &x : ns) {
+        var += (x - mean) * (x - mean);
+    }
+    const auto mid(ns.size() / 2);
+    const auto median(ns.size() % 2 ? ns[mid] : (ns[mid - 1] + ns[mid]) / 2);
+    return std::make_pair(result, summary{ns.front(), median, mean, std::sqrt(var / ns.size()), ns.back()});
+}
+
+// m clauses of k distinct variables out of n, random signs
+formula random_cnf(std::size_t n, std::size_t m, std::size_t k, std::mt19937_64 &rng) {
+    formula cnf;
+    std::vector<int> vars(n);
+    std::iota(vars.begin(), vars.end(), 1);
+    for (std::size_t j(0); j < m; j++) {
+        for (std::size_t i(0); i < k; i++) {
+            std::swap(vars[i], vars[i + rng() % (n - i)]);
+            cnf.add(rng() & 1 ? vars[i] : -vars[i]);
+        }
+        cnf.close();
+    }
+    cnf.n = n;
+    return cnf;
+}
+
+// m values below 2^bits and the sum of a random subset of them
+std::pair<scratch_vector<word>, word> random_subset_sum(std::size_t m, std::size_t bits, std::mt19937_64 &rng) {
+    scratch_vector<word> universe(m);
+    word t(0);
+    for (auto &u : universe) {
+        u = rng() >> (64 - bits);
+        t += rng() & 1 ? u : 0;
+    }
+    return std::make_pair(universe, t);
+}
+
+// the generator of one workload, from the run seed and the workload name: an
+// instance does not depend on where it sits in the grid, so a --quick row and
+// the full run's row of the same name build the same instance
+inline std::mt19937_64 workload_rng(std::uint64_t seed, const std::string &name) {
+    word h(1469598103934665603ull ^ seed);
+    for (const auto c : name) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return std::mt19937_64(h);
+}
+
+// fnv-1a over the words of x
+template<typename T>
+word checksum(const T &x) {
+    word h(1469598103934665603ull);
+    for (std::size_t i(0); i < x.size(); i++) {
+        h = (h ^ x[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+auto bench_cnf = [](std::size_t n, std::size_t m, std::size_t k, std::uint64_t seed, std::size_t warmup, std::size_t reps, std::vector<bench_row> &rows) {
+    const auto name("cnf-" + std::to_string(n) + "-" + std::to_string(m) + "-" + std::to_string(k));
+    auto rng(workload_rng(seed, name));
+    const auto cnf(random_cnf(n, m, k, rng));
+    auto add = [&](const char *stage, const std::pair<word, summary> &r) { rows.push_back({name, stage, n, m, k, r.first, r.second}); };
+    with_limbs(sum_width(n, m), [&](auto zero) {
+        using T = decltype(zero);
+        add("encode", measure([&] { return checksum(sat_equation<T>(cnf, m, n).first); }, warmup, reps));
+        const auto equation(sat_equation<T>(cnf, m, n));
+        const auto &sat(equation.first);
+        const auto &universe(equation.second);
+        add("count", measure([&] { return model_count(sat, n); }, warmup, reps));
+        writer out;
+        add("decode", measure([&] {
+            out.space(sat, std::size_t(1) << n, ORDER::INVERSE, BITS::BIN);
+            return word(out.take().size());
+        }, warmup, reps));
+        add("models", measure([&] {
+            word c(0);
+            for (const auto &x : models(sat, n)) {
+                c += x;
+            }
+            return c;
+        }, warmup, reps));
+        with_limbs(universe.size() + 1, [&](auto index) {
+            using N = decltype(index);
+            add("search", measure([&] {
+                phi_engine<N, cube_words, T> probe(universe, zero);
+                return checksum(abstract_binary_search<N>(universe, sat, probe).first);
+            }, warmup, reps));
+        });
+    });
+};
+
+auto bench_subset_sum = [](std::size_t m, std::size_t bits, std::uint64_t seed, std::size_t warmup, std::size_t reps, std::vector<bench_row> &rows) {
+    const auto name("subset-sum-" + std::to_string(m) + "-" + std::to_string(bits));
+    auto rng(workload_rng(seed, name));
+    const auto instance(random_subset_sum(m, bits, rng));
+    const auto &universe(instance.first);
+    limbs<1> t;
+    t[0] = instance.second;
+    with_limbs(m + 1, [&](auto index) {
+        using N = decltype(index);
+        for (const auto mode : {PHI::SCAN, PHI::DELTA, PHI::TABLES}) {
+            const auto r(measure([&] {
+                phi_engine<N, word, limbs<1>> probe(universe, limbs<1>(), mode, 0, std::size_t(64) << 20);
+                return checksum(abstract_binary_search<N>(universe, t, probe).first);
+            }, warmup, reps));
+            rows.push_back({name, std::string("search-") + phi_name(mode), bits, m, 0, r.first, r.second});
+        }
+    });
+};
+
+auto write_rows = [](const std::vector<bench_row> &rows, std::uint64_t seed, std::size_t warmup, std::size_t reps, std::ostream &out) {
+    out << "# unt_bench seed=" << seed << " warmup=" << warmup << " reps=" << reps << "\n";
+    out << "workload,stage,n,m,k,result,min_ns,median_ns,mean_ns,stddev_ns,max_ns\n";
+    for (const auto &r : rows) {
+        out << r.workload << ',' << r.stage << ',' << r.n << ',' << r.m << ',' << r.k << ',' << std::hex << r.result << std::dec << ','
+            << std::llround(r.time.min) << ',' << std::llround(r.time.median) << ',' << std::llround(r.time.mean) << ','
+            << std::llround(r.time.stddev) << ',' << std::llround(r.time.max) << "\n";
+    }
+};
+
+// (workload, stage) -> (result, median_ns) of an earlier run
+auto read_baseline = [](const std::string &path) {
+    std::map<std::pair<std::string, std::string>, std::pair<std::string, double>> base;
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error(path + ": cannot open");
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#' || !line.compare(0, 9, "workload,")) {
+            continue;
+        }
+        std::vector<std::string> f;
+        std::stringstream fields(line);
+        for (std::string x; std::getline(fields, x, ',');) {
+            f.push_back(x);
+        }
+        if (f.size() >= 8) {
+            base[std::make_pair(f[0], f[1])] = std::make_pair(f[5], std::stod(f[7]));
+        }
+    }
+    return base;
+};
+
+int main(int argc, char *argv[]) {
+    std::uint64_t seed(1);
+    std::size_t warmup(2), reps(10);
+    double threshold(10), floor(10000);
+    bool quick(false);
+    std::string output("-"), baseline;
+    for (auto i(1); i < argc; i++) {
+        if (auto v = value_of(argv[i], "--seed")) {
+            seed = std::strtoull(v, nullptr, 10);
+        } else if (auto v = value_of(argv[i], "--warmup")) {
+            warmup = std::strtoull(v, nullptr, 10);
+        } else if (auto v = value_of(argv[i], "--reps")) {
+            reps = std::max<std::size_t>(std::strtoull(v, nullptr, 10), 1);
+        } else if (auto v = value_of(argv[i], "--out")) {
+            output = v;
+        } else if (auto v = value_of(argv[i], "--baseline")) {
+            baseline = v;
+        } else if (auto v = value_of(argv[i], "--threshold")) {
+            threshold = std::strtod(v, nullptr);
+        } else if (auto v = value_of(argv[i], "--floor")) {
+            floor = std::strtod(v, nullptr);
+        } else if (!std::strcmp(argv[i], "--quick")) {
+            quick = true;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [options]" << std::endl;
+            std::cerr << "  --seed=S          generator seed (1)" << std::endl;
+            std::cerr << "  --warmup=W        untimed runs per stage (2)" << std::endl;
+            std::cerr << "  --reps=R          timed runs per stage (10)" << std::endl;
+            std::cerr << "  --quick           the small end of the grid only" << std::endl;
+            std::cerr << "  --out=FILE        where the CSV goes (- for stdout)" << std::endl;
+            std::cerr << "  --baseline=FILE   compare against an earlier CSV, fail on regressions" << std::endl;
+            std::cerr << "  --threshold=PCT   median slowdown that counts as a regression (10)" << std::endl;
+            std::cerr << "  --floor=NS        medians below this are noise, never regressions (10000)" << std::endl;
+            return std::strcmp(argv[i], "-h") && std::strcmp(argv[i], "--help") ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    }
+
+    std::vector<bench_row> rows;
+    const auto ns(quick ? std::vector<std::size_t>{10, 14} : std::vector<std::size_t>{14, 18, 22});
+    for (const auto n : ns) {
+        for (const auto k : {3, 5}) {
+            for (const auto ratio : {2, 4}) {
+                std::cerr << "cnf n=" << n << " m=" << ratio * n << " k=" << k << std::endl;
+                bench_cnf(n, ratio * n, k, seed, warmup, reps, rows);
+            }
+        }
+    }
+    const auto ms(quick ? std::vector<std::size_t>{16, 24} : std::vector<std::size_t>{16, 32, 48, 64});
+    for (const auto m : ms) {
+        std::cerr << "subset-sum m=" << m << std::endl;
+        bench_subset_sum(m, 40, seed, warmup, reps, rows);
+    }
+
+    if (output == "-") {
+        write_rows(rows, seed, warmup, reps, std::cout);
+    } else {
+        std::ofstream out(output);
+        write_rows(rows, seed, warmup, reps, out);
+        if (!out) {
+            std::cerr << argv[0] << ": " << output << ": cannot write" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (baseline.empty()) {
+        return EXIT_SUCCESS;
+    }
+    std::size_t regressions(0);
+    try {
+        const auto base(read_baseline(baseline));
+        for (const auto &r : rows) {
+            const auto b(base.find(std::make_pair(r.workload, r.stage)));
+            if (b == base.end()) {
+                continue;
+            }
+            std::stringstream result;
+            result << std::hex << r.result;
+            if (b->second.first != result.str()) {
+                std::cerr << "CHANGED    " << r.workload << " " << r.stage << ": result " << b->second.first << " -> " << result.str() << std::endl;
+                regressions++;
+            }
+            const auto change(b->second.second > 0 ? 100 * (r.time.median / b->second.second - 1) : 0);
+            if (change > threshold && r.time.median > floor) {
+                std::cerr << "REGRESSION " << r.workload << " " << r.stage << ": median " << std::llround(b->second.second) << " -> "
+                          << std::llround(r.time.median) << " ns (+" << std::llround(change) << "%)" << std::endl;
+                regressions++;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
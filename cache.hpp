@@ -0,0 +1,277 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_CACHE_HPP
+#define UNT_CACHE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "dimacs.hpp"
+#include "limbs.hpp"
+
+// solved instances by content. the falsification table does not depend on the
+// order of the clauses or of their literals, nor on repeats of either, so a
+// table is looked up by the canonical form of its formula: each clause sorted
+// by variable (negative first) without repeated literals, then the clauses
+// sorted and without repeats. the universe, and with it the universal index,
+// follows the order of the clauses but not that of their literals, so a search
+// is looked up by the clauses in the order read, each in canonical form.
+//
+// variables keep their numbers. renaming them permutes the 2^n assignments, so
+// a cached table would have to be permuted back on every hit.
+//
+// the cache file is a log: the entries found in it are loaded at start, each
+// new one is appended. a record cut short (a killed run) is cut off the file; a
+// log of more records than the cache keeps (entries evicted or stored again) is
+// rewritten with the ones kept. words are stored in host byte order.
+
+// by variable, negative first
+inline bool literal_before(int a, int b) {
+    const auto x(a > 0 ? a : -a), y(b > 0 ? b : -b);
+    return x != y ? x < y : a < b;
+}
+
+// the clauses of cnf, each sorted without repeated literals
+inline std::vector<std::vector<int>> sorted_clauses(const formula &cnf) {
+    std::vector<std::vector<int>> clauses;
+    clauses.reserve(cnf.size());
+    for (std::size_t j(0); j < cnf.size(); j++) {
+        std::vector<int> c(cnf[j].begin(), cnf[j].end());
+        std::sort(c.begin(), c.end(), literal_before);
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        clauses.push_back(std::move(c));
+    }
+    return clauses;
+}
+
+inline formula clause_formula(const std::vector<std::vector<int>> &clauses, std::size_t n) {
+    formula out;
+    for (const auto &c : clauses) {
+        for (const auto &l : c) {
+            out.add(l);
+        }
+        out.close();
+    }
+    out.n = n;
+    return out;
+}
+
+// what the table depends on
+inline formula canonical(const formula &cnf) {
+    auto clauses(sorted_clauses(cnf));
+    std::sort(clauses.begin(), clauses.end(), [](const std::vector<int> &a, const std::vector<int> &b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), literal_before);
+    });
+    clauses.erase(std::unique(clauses.begin(), clauses.end()), clauses.end());
+    return clause_formula(clauses, cnf.n);
+}
+
+// what the universe depends on: the clauses keep their order
+inline formula canonical_clauses(const formula &cnf) { return clause_formula(sorted_clauses(cnf), cnf.n); }
+
+// the layout of the universe the cached indices refer to; bumped when it changes
+constexpr int cache_version = 3;
+
+// what identifies a result: the layout, n, the search lanes (a k-ary search may
+// stop at another index; 0 for a table, which has no search) and the clauses,
+// each ended by a 0
+inline std::vector<int> cache_key(const formula &cnf, std::size_t lanes) {
+    std::vector<int> key{cache_version, static_cast<int>(cnf.n), static_cast<int>(lanes)};
+    key.reserve(3 + cnf.literals.size() + cnf.size());
+    for (std::size_t j(0); j < cnf.size(); j++) {
+        key.insert(key.end(), cnf[j].begin(), cnf[j].end());
+        key.push_back(0);
+    }
+    return key;
+}
+
+// two literals per multiply, finished by the murmur3 mix
+inline word cache_hash(const std::vector<int> &key) {
+    word h(0x9e3779b97f4a7c15ull ^ key.size());
+    std::size_t i(0);
+    for (; i + 1 < key.size(); i += 2) {
+        const auto x(word(std::uint32_t(key[i])) | word(std::uint32_t(key[i + 1])) << 32);
+        h = (h ^ x) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    if (i < key.size()) {
+        h = (h ^ std::uint32_t(key[i])) * 0xff51afd7ed558ccdull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    return h ^ h >> 33;
+}
+
+// a table (sat) or a search (universal and its counters)
+struct cached_solve {
+    std::vector<int> key;
+    std::vector<word> sat, universal;
+    __int128 complexity = 0, probes = 0;
+};
+
+// the last `capacity` results used, most recent first; shared by batch workers
+class result_cache {
+public:
+    explicit result_cache(std::size_t capacity, const std::string &path = "") : capacity(std::max<std::size_t>(capacity, 1)) {
+        if (path.empty()) {
+            return;
+        }
+        if (load(path) > order.size()) {
+            compact(path);
+        }
+        log.open(path, std::ios::binary | std::ios::app);
+        if (!log) {
+            throw std::runtime_error(path + ": cannot write");
+        }
+    }
+
+    result_cache(const result_cache &) = delete;
+
+    result_cache &operator=(const result_cache &) = delete;
+
+    std::shared_ptr<const cached_solve> find(word hash, const std::vector<int> &key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto e(index.find(hash));
+        if (e == index.end() || e->second->second->key != key) {
+            return nullptr;
+        }
+        order.splice(order.begin(), order, e->second);
+        return e->second->second;
+    }
+
+    std::shared_ptr<const cached_solve> insert(word hash, cached_solve r) {
+        auto entry(std::make_shared<const cached_solve>(std::move(r)));
+        std::lock_guard<std::mutex> lock(mutex);
+        keep(hash, entry);
+        if (log.is_open()) {
+            append(hash, *entry);
+        }
+        return entry;
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return order.size();
+    }
+
+private:
+    using entry = std::pair<word, std::shared_ptr<const cached_solve>>;
+
+    void keep(word hash, const std::shared_ptr<const cached_solve> &r) {
+        const auto e(index.find(hash));
+        if (e != index.end()) {
+            order.erase(e->second);
+        }
+        order.emplace_front(hash, r);
+        index[hash] = order.begin();
+        if (order.size() > capacity) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+    }
+
+    template<typename V>
+    static void put(std::ostream &to, const std::vector<V> &v) {
+        const std::uint64_t k(v.size());
+        to.write(reinterpret_cast<const char *>(&k), sizeof(k));
+        to.write(reinterpret_cast<const char *>(v.data()), k * sizeof(V));
+    }
+
+    template<typename V>
+    static bool get(std::istream &in, std::vector<V> &v) {
+        std::uint64_t k(0);
+        if (!in.read(reinterpret_cast<char *>(&k), sizeof(k)) || k > (std::uint64_t(1) << 40) / sizeof(V)) {
+            return false;
+        }
+        v.resize(k);
+        return bool(in.read(reinterpret_cast<char *>(v.data()), k * sizeof(V)));
+    }
+
+    void append(word hash, const cached_solve &r) {
+        write(log, hash, r);
+        log.flush();
+    }
+
+    static void write(std::ostream &to, word hash, const cached_solve &r) {
+        to.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+        put(to, r.key);
+        put(to, r.sat);
+        put(to, r.universal);
+        to.write(reinterpret_cast<const char *>(&r.complexity), sizeof(r.complexity));
+        to.write(reinterpret_cast<const char *>(&r.probes), sizeof(r.probes));
+    }
+
+    // the entries kept, least recent first so a load puts them back in order,
+    // to a new file renamed over path
+    void compact(const std::string &path) {
+        const auto tmp(path + ".tmp");
+        {
+            std::ofstream to(tmp, std::ios::binary | std::ios::trunc);
+            for (auto e(order.rbegin()); e != order.rend(); e++) {
+                write(to, e->first, *e->second);
+            }
+            if (!to.flush()) {
+                throw std::runtime_error(tmp + ": cannot write");
+            }
+        }
+        if (::rename(tmp.c_str(), path.c_str())) {
+            throw std::runtime_error(path + ": cannot replace");
+        }
+    }
+
+    // the records read
+    std::size_t load(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        std::streamoff good(0);
+        std::size_t records(0);
+        word hash;
+        while (in.read(reinterpret_cast<char *>(&hash), sizeof(hash))) {
+            cached_solve r;
+            if (!get(in, r.key) || !get(in, r.sat) || !get(in, r.universal) ||
+                !in.read(reinterpret_cast<char *>(&r.complexity), sizeof(r.complexity)) ||
+                !in.read(reinterpret_cast<char *>(&r.probes), sizeof(r.probes))) {
+                break;
+            }
+            keep(hash, std::make_shared<const cached_solve>(std::move(r)));
+            good = in.tellg();
+            records++;
+        }
+        in.clear();
+        if (in.is_open() && in.seekg(0, std::ios::end) && in.tellg() > good) {
+            in.close();
+            if (::truncate(path.c_str(), good)) {
+                throw std::runtime_error(path + ": cannot truncate");
+            }
+        }
+        return records;
+    }
+
+    std::size_t capacity;
+    std::list<entry> order;
+    std::unordered_map<word, std::list<entry>::iterator> index;
+    std::ofstream log;
+    mutable std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,397 @@
+#!/usr/bin/env python3
+###############################################################################
+#   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    #
+#                           oscar.riveros@peqnp.com                         #
+#                                                                           #
+#   without any restriction, Oscar Riveros reserved rights, patents and     #
+#  commercialization of this knowledge or derived directly from this work.  #
+###############################################################################
+
+# regression check: unt against brute force on small formulas. the table, the
+# clause terms and phi are exact python integers, so a sum never wraps; the
+# serial abstract binary search is replayed on them round for round. every
+# engine and option runs on each formula: where one may end elsewhere than the
+# serial search (--probes, --shards, a warm --edits start) its index must
+# still match, or be 0.
+#
+#   python3 check.py [path to unt]
+
+import json
+import os
+import random
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+UNT = os.path.abspath(sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__) or '.', 'unt'))
+WORK = tempfile.mkdtemp(prefix='unt-check-')
+SOCKET = os.path.join(WORK, 'serve.sock')
+failures = []
+checks = 0
+
+# formulas that once broke a run, as (name, n, clauses)
+FIXED = [
+    # phi of index 384 is >= 2^128: a sum 2^n bits wide wrapped and the search
+    # turned away from 320
+    ('overflow', 7, [[1, -3], [4, 1], [-5, -7, -4], [-4, 1, 6], [2, 4], [6, 5, -1], [-6], [4, 2], [6]]),
+    # a tautology is never falsified, its term is zero
+    ('tautology', 2, [[1, -1]]),
+    ('tautologies', 3, [[1, -1, 2], [-3], [2, 3, -2], [1, 2]]),
+    # --cache solved the canonical form: another clause order, one clause fewer
+    ('cache-order', 2, [[-2], [1], [2, 1]]),
+    ('cache-repeat', 2, [[1, 2], [1], [1]]),
+]
+
+
+def falsifies(n, k, clause):
+    # bit n - v of a table index set: variable v is false
+    return all(((k >> (n - abs(l))) & 1) == (l > 0) for l in clause)
+
+
+def terms_of(n, clauses):
+    return [sum(1 << k for k in range(1 << n) if falsifies(n, k, c)) for c in clauses]
+
+
+def table_of(n, terms):
+    t = 0
+    for u in terms:
+        t |= u
+    return t
+
+
+def phi(x, terms):
+    return sum(u for j, u in enumerate(terms) if (x >> j) & 1)
+
+
+# the serial search: the index and its rounds, or 0 and the rounds
+def binary_search(terms, t):
+    i, j, rounds = 0, 1 << len(terms), 0
+    while i < j:
+        mid = (i + j) // 2
+        s = phi(mid, terms)
+        if s < t:
+            i = mid + 1
+        elif s > t:
+            j = mid
+        else:
+            return mid, rounds
+        rounds += 1
+    return 0, rounds
+
+
+def matches(terms, t):
+    return [x for x in range(1 << len(terms)) if phi(x, terms) == t]
+
+
+def write_cnf(name, n, clauses):
+    path = os.path.join(WORK, name + '.cnf')
+    with open(path, 'w') as f:
+        f.write('p cnf %d %d\n' % (n, len(clauses)))
+        for c in clauses:
+            f.write(' '.join(map(str, c)) + ' 0\n')
+    return path
+
+
+def run(args, path):
+    r = subprocess.run([UNT, '--format=json', '--models=count'] + args + [path], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                       universal_newlines=True, timeout=120)
+    if r.returncode:
+        raise RuntimeError(r.stderr.strip())
+    return [json.loads(line) for line in r.stdout.splitlines() if line.startswith('{')]
+
+
+# the text form: the first value of each label
+def run_text(args, path):
+    r = subprocess.run([UNT, '--models=count'] + args + [path], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                       universal_newlines=True, timeout=120)
+    if r.returncode:
+        raise RuntimeError(r.stderr.strip())
+    fields = {}
+    for line in r.stdout.splitlines():
+        key, colon, value = line.partition(':')
+        if colon:
+            fields.setdefault(key.strip(), value.strip())
+    return fields
+
+
+# one cnf job on the --serve socket
+def run_serve(name, path):
+    with open(path) as f:
+        job = 'cnf %s\n%send\n' % (name, f.read())
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as c:
+        c.connect(SOCKET)
+        c.sendall(job.encode())
+        reply = b''
+        while b'\n' not in reply:
+            reply += c.recv(1 << 16)
+        head, _, body = reply.partition(b'\n')
+        status = head.decode().split()
+        if status[0] != 'ok':
+            raise RuntimeError(head.decode())
+        while len(body) < int(status[2]):
+            body += c.recv(1 << 16)
+    return [json.loads(line) for line in body.decode().splitlines() if line.startswith('{')]
+
+
+def check(name, args, ok, detail):
+    global checks
+    checks += 1
+    if not ok:
+        failures.append('%s %s: %s' % (name, ' '.join(args), detail))
+
+
+def solve(name, n, clauses):
+    path = write_cnf(name, n, clauses)
+    terms = terms_of(n, clauses)
+    t = table_of(n, terms)
+    count = (1 << n) - bin(t).count('1')
+    universal, rounds = binary_search(terms, t)
+    # the probe of the last round is a round only when it misses
+    probes = rounds + (phi(universal, terms) == t)
+    found = matches(terms, t)
+    models = [[-v if (k >> (n - v)) & 1 else v for v in range(1, n + 1)] for k in range(1 << n) if not (t >> k) & 1]
+
+    def each(args, expect, valid=lambda r: True, records=1, runner=run):
+        try:
+            rs = runner(args, path)
+        except Exception as e:
+            check(name, args, False, str(e))
+            return
+        check(name, args, len(rs) == records, '%d records, expected %d' % (len(rs), records))
+        for r in rs:
+            check(name, args, r.get('sat_count') == count, 'sat_count %s, expected %d' % (r.get('sat_count'), count))
+            for key, value in expect.items():
+                check(name, args, r.get(key) == value, '%s %s, expected %s' % (key, r.get(key), value))
+            check(name, args, valid(r), 'universal %s is no match' % r.get('universal'))
+
+    for mode in ['auto', 'scan', 'delta', 'tables']:
+        each(['--phi=' + mode], {'universal': str(universal), 'abs_complexity': rounds})
+    each(['--cubes=2'], {'universal': str(universal), 'abs_complexity': rounds})
+    each(['--checkpoint=' + os.path.join(WORK, name + '.ck')], {'universal': str(universal), 'abs_complexity': rounds, 'phi_calls': probes})
+    each(['--batch', path], {'universal': str(universal), 'abs_complexity': rounds}, records=2)
+    each([], {'universal': str(universal), 'abs_complexity': rounds}, runner=lambda args, path: run_serve(name, path))
+    text = run_text([], path)
+    check(name, ['(text)'], text.get('SAT COUNT') == str(count) and text.get('UNIVERSAL') == str(universal), 'SAT COUNT %s, UNIVERSAL %s' %
+          (text.get('SAT COUNT'), text.get('UNIVERSAL')))
+    # the formula the search runs on is another one: the table and the models
+    each(['--preprocess', '--models=all'], {'models': models})
+    first_sat(name, n, clauses, path, models)
+    edits(name, n, clauses, path)
+    # a miss, then a hit from the file: both as without the cache
+    cache = os.path.join(WORK, name + '.cache')
+    for state in ['miss', 'hit']:
+        each(['--cache-file=' + cache], {'universal': str(universal), 'abs_complexity': rounds, 'm': len(clauses), 'cache': state})
+    # the literals reversed: the same universe, its search is a hit
+    solve_cached(name + '-literals', n, [c[::-1] for c in clauses], cache, 'hit')
+    # the clauses reversed: the same table, searched in their own order
+    if len(clauses) > 1:
+        solve_cached(name + '-reversed', n, clauses[::-1], cache, 'hit' if clauses[::-1] == clauses else 'table')
+    each(['--models=all'], {'models': models})
+    each(['--out-of-core=' + WORK, '--models=all'], {'models': models, 'universal': str(universal), 'abs_complexity': rounds})
+    # parallel probing cuts [i, j) elsewhere: any match, or none
+    for args in [['--probes=3'], ['--shards=2']]:
+        each(args, {}, lambda r: int(r['universal']) in [0] + found)
+    each(['--engine=hs', '--matches=all'], {'hs_matches': len(found), 'universals': [str(x) for x in found] or None})
+    # the k least matches, whatever order the merge meets them in
+    each(['--engine=hs', '--matches=2'], {'hs_matches': len(found), 'universals': [str(x) for x in found[:2]] or None})
+    each(['--engine=exhaustive'], {'ex_matches': len(found), 'universal': str(found[0] if found else 0)})
+    each(['--engine=exhaustive', '--shards=2'], {'ex_matches': len(found), 'universal': str(found[0] if found else 0)})
+
+
+# one model of the formula, or none when it has none
+def first_sat(name, n, clauses, path, models):
+    for args in [['--first-sat'], ['--first-sat', '--cubes=2']]:
+        try:
+            r = run(args, path)[0]
+        except Exception as e:
+            check(name, args, False, str(e))
+            continue
+        got = r.get('models')
+        check(name, args, got in ([[m] for m in models] if models else [[]]), 'model %s' % got)
+
+
+# --edits: an add, a tautology added and removed, a remove, a re-add, each
+# checked against the formula of the live slots; a warm start carries a match
+def edits(name, n, clauses, path):
+    rng = random.Random(name)
+    slots, vacant = list(clauses), []
+    script, expect = [], [list(slots)]
+
+    def add(c):
+        script.append('a ' + ' '.join(map(str, c)) + ' 0')
+        if vacant:
+            slots[vacant.pop()] = c
+        else:
+            slots.append(c)
+        expect.append(list(slots))
+
+    def remove(k):
+        script.append('d %d' % k)
+        slots[k] = None
+        vacant.append(k)
+        expect.append(list(slots))
+
+    v = rng.randint(1, n)
+    add([v, -rng.randint(1, n) if n > 1 else -v])
+    add([v, -v])
+    remove(len(slots) - 1)
+    remove(0)
+    add([-v])
+    edits_path = os.path.join(WORK, name + '.edits')
+    with open(edits_path, 'w') as f:
+        f.write('\n'.join(script) + '\n')
+    args = ['--edits=' + edits_path]
+    try:
+        rs = run(args, path)
+    except Exception as e:
+        check(name, args, False, str(e))
+        return
+    check(name, args, len(rs) == len(expect), '%d records, expected %d' % (len(rs), len(expect)))
+    for r, live in zip(rs, expect):
+        terms = [0 if c is None else terms_of(n, [c])[0] for c in live]
+        t = table_of(n, terms)
+        universal, rounds = binary_search(terms, t)
+        step = args + [r.get('edit')]
+        check(name, step, r.get('sat_count') == (1 << n) - bin(t).count('1'), 'sat_count %s' % r.get('sat_count'))
+        if r.get('warm') == 'yes':
+            check(name, step, phi(int(r['universal']), terms) == t, 'universal %s is no match' % r['universal'])
+        else:
+            check(name, step, r.get('universal') == str(universal) and r.get('abs_complexity') == rounds,
+                  'universal %s in %s rounds, expected %d in %d' % (r.get('universal'), r.get('abs_complexity'), universal, rounds))
+
+
+# another form of a formula in the cache: state is what the cache finds of it
+def solve_cached(name, n, clauses, cache, state):
+    args = ['--cache-file=' + cache]
+    universal, rounds = binary_search(terms_of(n, clauses), table_of(n, terms_of(n, clauses)))
+    try:
+        r = run(args, write_cnf(name, n, clauses))[0]
+    except Exception as e:
+        check(name, args, False, str(e))
+        return
+    for key, value in {'universal': str(universal), 'abs_complexity': rounds, 'cache': state}.items():
+        check(name, args, r.get(key) == value, '%s %s, expected %s' % (key, r.get(key), value))
+
+
+# a run killed once its checkpoint holds a search state, then resumed, ends as
+# a clean run does: the same table, index, rounds and phi calls. scan phi over
+# 800 clauses keeps the search going for seconds
+def resume():
+    rng = random.Random('resume')
+    n = 22
+    clauses = [[v if rng.random() < 0.5 else -v for v in rng.sample(range(1, n + 1), 5)] for _ in range(800)]
+    path = write_cnf('resume', n, clauses)
+    ck = os.path.join(WORK, 'resume.ck')
+    args = ['--phi=scan', '--checkpoint=' + ck]
+    fields = ['sat_count', 'universal', 'abs_complexity', 'abs_probes', 'phi_calls']
+    try:
+        clean = run(['--phi=scan'], path)[0]
+        killed = subprocess.Popen([UNT, '--format=json', '--models=count', '--checkpoint-every=1'] + args + [path], stdout=subprocess.DEVNULL)
+        # the state of a search is past the 96 bytes of the header, counters and empty bounds
+        while killed.poll() is None and not (os.path.exists(ck) and os.path.getsize(ck) > 96):
+            time.sleep(0.01)
+        killed.kill()
+        check('resume', args, killed.wait() < 0, 'the run ended before a search snapshot')
+        r = run(args + ['--resume'], path)[0]
+    except Exception as e:
+        check('resume', args, False, str(e))
+        return
+    check('resume', args, r.get('resumed') is True, 'not resumed')
+    for key in fields:
+        check('resume', args, r.get(key) == clean[key], '%s %s, expected %s' % (key, r.get(key), clean[key]))
+
+
+# a header that claims 2e9 clauses is not taken at its word
+def header():
+    path = os.path.join(WORK, 'header.cnf')
+    with open(path, 'w') as f:
+        f.write('p cnf 3 2000000000\n1 2 0\n-3 0\n')
+    try:
+        r = run([], path)[0]
+    except Exception as e:
+        check('header', [], False, str(e))
+        return
+    check('header', [], r.get('sat_count') == 3 and r.get('m') == 2, 'sat_count %s, m %s' % (r.get('sat_count'), r.get('m')))
+
+
+# a cache log of more records than --cache keeps is rewritten with the ones kept
+def cache_log():
+    cache = os.path.join(WORK, 'log.cache')
+    paths = [write_cnf('log-%d' % k, 2, [[k % 2 + 1]]) for k in range(4)]
+    args = ['--cache=2', '--cache-file=' + cache]
+    sizes = []
+    for _ in range(3):
+        subprocess.run([UNT, '--models=count'] + args + paths, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        sizes.append(os.path.getsize(cache))
+    check('cache-log', args, sizes[1] == sizes[2], 'log sizes %s' % sizes)
+
+
+# a full --queue answers busy at once, and the reader still takes a cancel
+def serve_busy():
+    rng = random.Random('busy')
+    clauses = [[v if rng.random() < 0.5 else -v for v in rng.sample(range(1, 23), 5)] for _ in range(800)]
+    with open(write_cnf('busy', 22, clauses)) as f:
+        body = f.read()
+    path = os.path.join(WORK, 'busy.sock')
+    args = ['--serve=' + path, '--queue=1', '--phi=scan']
+    server = subprocess.Popen([UNT, '--format=json', '--models=count'] + args, stderr=subprocess.DEVNULL)
+    while not os.path.exists(path) and server.poll() is None:
+        time.sleep(0.01)
+    try:
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as c:
+            c.settimeout(60)
+            c.connect(path)
+            c.sendall(('cnf a\n%send\ncnf b\n%send\ncancel a\n' % (body, body)).encode())
+            reply = b''
+            while reply.count(b'\n') < 2:
+                reply += c.recv(1 << 16)
+        lines = reply.decode().splitlines()[:2]
+        check('serve', args, lines == ['busy b', 'stopped a cancelled'], 'replies %s' % lines)
+    except Exception as e:
+        check('serve', args, False, str(e))
+    server.terminate()
+    server.wait()
+
+
+def random_formula(rng):
+    n = rng.randint(1, 8)
+    clauses = []
+    for _ in range(rng.randint(1, 12)):
+        vs = rng.sample(range(1, n + 1), rng.randint(1, min(n, 3)))
+        c = [v if rng.random() < 0.5 else -v for v in vs]
+        if rng.random() < 0.1:
+            c.append(-c[0])
+        clauses.append(c)
+    return n, clauses
+
+
+def main():
+    if not os.access(UNT, os.X_OK):
+        sys.exit('check.py: no %s, build it with compile.sh' % UNT)
+    server = subprocess.Popen([UNT, '--serve=' + SOCKET, '--format=json', '--models=count'], stderr=subprocess.DEVNULL)
+    while not os.path.exists(SOCKET) and server.poll() is None:
+        time.sleep(0.01)
+    for name, n, clauses in FIXED:
+        solve(name, n, clauses)
+    rng = random.Random(1)
+    for i in range(40):
+        n, clauses = random_formula(rng)
+        solve('random-%d' % i, n, clauses)
+    resume()
+    header()
+    cache_log()
+    serve_busy()
+    server.terminate()
+    server.wait()
+    shutil.rmtree(WORK)
+    for f in failures:
+        print('FAIL ' + f)
+    print('%d checks, %d failed' % (checks, len(failures)))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
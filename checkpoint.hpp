@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_CHECKPOINT_HPP
+#define UNT_CHECKPOINT_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arena.hpp"
+#include "limbs.hpp"
+#include "profile.hpp"
+#include "table.hpp"
+
+// where a search stands: the index range [i, j) still open, the rounds (the
+// complexity counter) and the phi probes so far
+template<typename N>
+struct search_state {
+    N i, j;
+    __int128 rounds, probes;
+};
+
+// periodic snapshots of one solve, for --resume after the process is killed.
+//
+// FILE holds the state: the instance it belongs to, how many tiles of the
+// falsification table are built, and the search state once the table is done.
+// FILE.table holds the table itself; finished tiles are written there in place
+// and synced before the state that counts them, so a state never claims a tile
+// the table file does not have. the state is replaced atomically: written to
+// FILE.tmp, synced, renamed over FILE, and the directory synced.
+//
+// a snapshot is due every `interval`, at least checkpoint_floor; the ticks
+// between are one clock read. the tiles built since the last snapshot are only
+// written with the next one, so a solve shorter than the interval writes and
+// syncs nothing. the files are removed when the solve completes.
+//
+// a resumed run counts the phi calls and their time from the start of the
+// first run: those of the runs before it are kept with the search state.
+constexpr std::chrono::seconds checkpoint_floor(1);
+
+class checkpoint {
+public:
+    // resume: continue from FILE if it is there (it must be of this instance)
+    checkpoint(const std::string &path, word instance, std::size_t n, std::chrono::nanoseconds interval, bool resume)
+            : path(path), instance(instance), n(n), interval(std::max<std::chrono::nanoseconds>(interval, checkpoint_floor)),
+              last(std::chrono::steady_clock::now()) {
+        if (resume) {
+            load();
+        }
+        fd = ::open((path + ".table").c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error(path + ".table: cannot open");
+        }
+    }
+
+    checkpoint(const checkpoint &) = delete;
+
+    checkpoint &operator=(const checkpoint &) = delete;
+
+    ~checkpoint() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    // the falsification table of cubes, from the tiles saved on, saving every
+    // interval
+    template<typename T>
+    void build(const scratch_vector<cube_words> &cubes, T &table) {
+        const auto tiles(table_tiles(n));
+        table.clear();
+        if (built) {
+            read_words(table.data(), built * table_tile(n));
+        }
+        const auto step(std::max<std::size_t>(1, std::min<std::size_t>(tiles / 64, 256)));
+        while (built < tiles) {
+            const auto to(std::min(tiles, built + step));
+            falsification_tiles(cubes, n, table, built, to);
+            built = to;
+            if (due()) {
+                phase_timer timer(CHECKPOINT);
+                commit(table.data());
+            }
+        }
+    }
+
+    // the search state saved, if any; probe counts its calls from 0 on, the
+    // earlier ones are phi_calls and phi_time
+    template<typename N>
+    bool restore(search_state<N> &at) const {
+        if (i.empty()) {
+            return false;
+        }
+        at.i.clear();
+        at.j.clear();
+        std::copy(i.begin(), i.begin() + std::min(i.size(), at.i.size()), at.i.data());
+        std::copy(j.begin(), j.begin() + std::min(j.size(), at.j.size()), at.j.data());
+        at.rounds = rounds;
+        at.probes = probes;
+        return true;
+    }
+
+    // after a search round: saves at, and the phi work of probe, if a snapshot
+    // is due. table is the one build() made, wherever it is now: the tiles
+    // built since the last snapshot are written from it
+    template<typename N, typename E, typename T>
+    void tick(const search_state<N> &at, const E &probe, const T &table) {
+        if (!due()) {
+            return;
+        }
+        phase_timer timer(CHECKPOINT);
+        i.assign(at.i.data(), at.i.data() + at.i.size());
+        j.assign(at.j.data(), at.j.data() + at.j.size());
+        rounds = at.rounds;
+        probes = at.probes;
+        calls = phi_calls + probe.calls;
+        time = phi_time + probe.elapsed;
+        commit(table.data());
+    }
+
+    // the solve is complete: the snapshots go
+    void finish() {
+        ::unlink(path.c_str());
+        ::unlink((path + ".table").c_str());
+    }
+
+    bool resumed() const { return from_file; }
+
+    std::size_t written = 0;
+    std::chrono::nanoseconds spent{0};
+    // the phi calls of the runs this one resumes, and their time
+    std::size_t phi_calls = 0;
+    std::chrono::nanoseconds phi_time{0};
+
+private:
+    bool due() {
+        const auto now(std::chrono::steady_clock::now());
+        if (now - last < interval) {
+            return false;
+        }
+        last = now;
+        return true;
+    }
+
+    void read_words(word *d, std::size_t count) const {
+        const auto bytes(count * sizeof(word));
+        std::size_t done(0);
+        while (done < bytes) {
+            const auto r(::pread(fd, reinterpret_cast<char *>(d) + done, bytes - done, done));
+            if (r <= 0) {
+                throw std::runtime_error(path + ".table: shorter than its checkpoint");
+            }
+            done += r;
+        }
+    }
+
+    void write_words(const word *d, std::size_t at, std::size_t count) {
+        const auto bytes(count * sizeof(word));
+        std::size_t done(0);
+        while (done < bytes) {
+            const auto r(::pwrite(fd, reinterpret_cast<const char *>(d) + done, bytes - done, at * sizeof(word) + done));
+            if (r <= 0) {
+                throw std::runtime_error(path + ".table: write error");
+            }
+            done += r;
+        }
+        if (::fdatasync(fd)) {
+            throw std::runtime_error(path + ".table: cannot sync");
+        }
+    }
+
+    // FILE: magic, instance, n, tiles built, then i and j (word count and
+    // words, 0 before the search), the rounds and probes, and the phi calls and
+    // their time in ns. the tiles of table built since the last one go to
+    // FILE.table first
+    void commit(const word *table) {
+        const auto start(std::chrono::steady_clock::now());
+        if (saved < built) {
+            const auto tile(table_tile(n));
+            write_words(table + saved * tile, saved * tile, (built - saved) * tile);
+            saved = built;
+        }
+        std::vector<char> out;
+        auto put = [&](const void *p, std::size_t k) {
+            out.insert(out.end(), static_cast<const char *>(p), static_cast<const char *>(p) + k);
+        };
+        const std::uint64_t head[4] = {magic, instance, n, built};
+        put(head, sizeof(head));
+        for (const auto *v : {&i, &j}) {
+            const std::uint64_t k(v->size());
+            put(&k, sizeof(k));
+            put(v->data(), k * sizeof(word));
+        }
+        put(&rounds, sizeof(rounds));
+        put(&probes, sizeof(probes));
+        const std::uint64_t phi[2] = {calls, static_cast<std::uint64_t>(time.count())};
+        put(phi, sizeof(phi));
+
+        const auto tmp(path + ".tmp");
+        const auto f(::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        if (f < 0) {
+            throw std::runtime_error(tmp + ": cannot open");
+        }
+        const bool ok(::write(f, out.data(), out.size()) == static_cast<ssize_t>(out.size()) && !::fsync(f));
+        ::close(f);
+        if (!ok || ::rename(tmp.c_str(), path.c_str())) {
+            throw std::runtime_error(path + ": cannot write the checkpoint");
+        }
+        const auto slash(path.rfind('/'));
+        const auto dir(::open(slash == std::string::npos ? "." : path.substr(0, slash ? slash : 1).c_str(), O_RDONLY));
+        if (dir >= 0) {
+            ::fsync(dir);
+            ::close(dir);
+        }
+        written++;
+        spent += std::chrono::steady_clock::now() - start;
+    }
+
+    void load() {
+        const auto f(::open(path.c_str(), O_RDONLY));
+        if (f < 0) {
+            return;
+        }
+        std::vector<char> in;
+        char chunk[1 << 12];
+        for (ssize_t r; (r = ::read(f, chunk, sizeof(chunk))) > 0;) {
+            in.insert(in.end(), chunk, chunk + r);
+        }
+        ::close(f);
+        std::size_t at(0);
+        auto get = [&](void *p, std::size_t k) {
+            if (in.size() - at < k) {
+                throw std::runtime_error(path + ": truncated checkpoint");
+            }
+            std::memcpy(p, in.data() + at, k);
+            at += k;
+        };
+        std::uint64_t head[4];
+        get(head, sizeof(head));
+        if (head[0] != magic) {
+            throw std::runtime_error(path + ": not a checkpoint");
+        }
+        if (head[1] != instance || head[2] != n) {
+            throw std::runtime_error(path + ": checkpoint of another instance");
+        }
+        built = saved = std::min<std::size_t>(head[3], table_tiles(n));
+        for (auto *v : {&i, &j}) {
+            std::uint64_t k;
+            get(&k, sizeof(k));
+            if (k > (in.size() - at) / sizeof(word)) {
+                throw std::runtime_error(path + ": truncated checkpoint");
+            }
+            v->resize(k);
+            get(v->data(), k * sizeof(word));
+        }
+        get(&rounds, sizeof(rounds));
+        get(&probes, sizeof(probes));
+        std::uint64_t phi[2];
+        get(phi, sizeof(phi));
+        phi_calls = calls = phi[0];
+        phi_time = time = std::chrono::nanoseconds(phi[1]);
+        from_file = true;
+    }
+
+    static constexpr std::uint64_t magic = 0x32746e6b63746e75ull;  // "untcknt2"
+
+    std::string path;
+    word instance;
+    std::size_t n;
+    std::chrono::nanoseconds interval;
+    std::chrono::steady_clock::time_point last;
+    int fd = -1;
+    std::size_t built = 0, saved = 0;
+    std::vector<word> i, j;
+    __int128 rounds = 0, probes = 0;
+    std::size_t calls = 0;
+    std::chrono::nanoseconds time{0};
+    bool from_file = false;
+};
+
+#endif
@@ -1 +1,2 @@
-g++ -std=c++1z -Os sat_equation_and_abstract_binary_search.cpp -o unt
\ No newline at end of file
+g++ -std=gnu++17 -O3 -march=native -fopenmp sat_equation_and_abstract_binary_search.cpp -o unt
+g++ -std=gnu++17 -O3 -march=native -fopenmp bench.cpp -o unt_bench
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_CUBE_AND_CONQUER_HPP
+#define UNT_CUBE_AND_CONQUER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "arena.hpp"
+#include "deadline.hpp"
+#include "dimacs.hpp"
+#include "limbs.hpp"
+#include "table.hpp"
+
+// cube and conquer: variables 1..k sit on the top k bits of the table index,
+// so fixing them to one of 2^k values h selects the slice [h 2^(n-k), (h+1) 2^(n-k))
+// of the table. every slice is the table of the formula simplified by its
+// cube (satisfied clauses dropped, falsified literals removed) over the other
+// n - k variables, which keep their bit positions. the slices are solved in
+// parallel straight into the full table, so stitching costs nothing.
+
+// a word range of a larger table, with the interface falsification_table uses
+struct table_view {
+    word *d;
+    std::size_t words;
+
+    std::size_t size() const { return words; }
+
+    word *data() { return d; }
+
+    word &operator[](std::size_t i) { return d[i]; }
+
+    const word &operator[](std::size_t i) const { return d[i]; }
+
+    void clear() { std::fill(d, d + words, word(0)); }
+};
+
+// the clauses of cnf under the cube h of the first k variables, as cube terms
+// over the low n - k index bits; a bit of h set means its variable is false.
+// satisfied clauses and tautologies leave no cube
+inline void simplify(const formula &cnf, const std::size_t &n, const std::size_t &k, word h, scratch_vector<cube_words> &out) {
+    out.clear();
+    for (std::size_t j(0); j < cnf.size(); j++) {
+        cube c{0, 0};
+        bool satisfied(false);
+        for (const auto &l : cnf[j]) {
+            const auto v(static_cast<std::size_t>(l > 0 ? l : -l));
+            if (v <= k) {
+                satisfied |= (l > 0) == !((h >> (k - v)) & 1);
+            } else {
+                const auto p(n - v);
+                // v and -v: a tautology, never falsified
+                satisfied |= ((c.care >> p) & 1) && ((c.value >> p) & 1) != (l > 0);
+                c.care |= word(1) << p;
+                c.value |= l > 0 ? word(1) << p : word(0);
+            }
+        }
+        if (!satisfied) {
+            out.emplace_back(split(c, n - k));
+        }
+    }
+}
+
+// fills table (2^n bits) cube by cube. with first_sat the cubes stop as soon as
+// one of them has a model, and the table is only valid up to that cube.
+// returns the index of a satisfying table bit, or ~0 when none was seen. the
+// deadline of the calling thread is polled between cubes.
+template<typename T>
+word conquer_table(const formula &cnf, const std::size_t &n, std::size_t k, T &table, bool first_sat = false) {
+    k = std::min(k, n);
+    const auto rest(n - k);
+    const auto slice(table_words(rest));
+    std::atomic<word> found(~word(0));
+    const auto stop(deadline::current());
+    table.clear();
+#pragma omp parallel
+    {
+        scratch_vector<cube_words> clauses;
+#pragma omp for schedule(dynamic, 1)
+        for (std::ptrdiff_t h = 0; h < static_cast<std::ptrdiff_t>(word(1) << k); h++) {
+            if ((first_sat && found != ~word(0)) || (stop && stop->due())) {
+                continue;
+            }
+            simplify(cnf, n, k, h, clauses);
+            const auto base(static_cast<word>(h) << rest);
+            if (rest >= 6) {
+                table_view view{table.data() + h * slice, slice};
+                falsification_table(clauses, rest, view);
+                for (std::size_t w(0); w < slice && found == ~word(0); w++) {
+                    if (~view[w]) {
+                        word expected(~word(0));
+                        found.compare_exchange_strong(expected, base + 64 * w + __builtin_ctzll(~view[w]));
+                        break;
+                    }
+                }
+            } else {
+                limbs<1> part(64);
+                falsification_table(clauses, rest, part);
+                const auto width(std::size_t(1) << rest);
+                const auto free(~part[0] & ((word(1) << width) - 1));
+                if (free) {
+                    word expected(~word(0));
+                    found.compare_exchange_strong(expected, base + __builtin_ctzll(free));
+                }
+                __atomic_fetch_or(&table[base / 64], part[0] << (base % 64), __ATOMIC_RELAXED);
+            }
+        }
+    }
+    deadline::poll();
+    return found;
+}
+
+#endif
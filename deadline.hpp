@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_DEADLINE_HPP
+#define UNT_DEADLINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+// a solve stopped by its deadline or a cancel
+struct job_stopped : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// when a job must stop: a point in time, a cancel from another thread, or
+// both. a solve polls the deadline of its thread (set by a scope) between
+// search rounds and table tiles; a thread without one never stops.
+class deadline {
+public:
+    using clock = std::chrono::steady_clock;
+
+    deadline() = default;
+
+    explicit deadline(clock::time_point at) : at(at) {}
+
+    deadline(const deadline &) = delete;
+
+    deadline &operator=(const deadline &) = delete;
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    // why the job must stop, or nullptr
+    const char *due() const {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return "cancelled";
+        }
+        if (at != clock::time_point::max() && clock::now() >= at) {
+            return "deadline exceeded";
+        }
+        return nullptr;
+    }
+
+    void check() const {
+        if (const auto why = due()) {
+            throw job_stopped(why);
+        }
+    }
+
+    // the deadline of the calling thread, or nullptr
+    static const deadline *current() { return slot(); }
+
+    static void poll() {
+        if (const auto d = slot()) {
+            d->check();
+        }
+    }
+
+    // d is the deadline of the calling thread while the scope lives
+    class scope {
+    public:
+        explicit scope(const deadline &d) : saved(slot()) { slot() = &d; }
+
+        scope(const scope &) = delete;
+
+        scope &operator=(const scope &) = delete;
+
+        ~scope() { slot() = saved; }
+
+    private:
+        const deadline *saved;
+    };
+
+private:
+    static const deadline *&slot() {
+        static thread_local const deadline *d(nullptr);
+        return d;
+    }
+
+    std::atomic<bool> cancelled{false};
+    clock::time_point at = clock::time_point::max();
+};
+
+#endif
@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_DIMACS_HPP
+#define UNT_DIMACS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// a cnf as one flat literal array: clause j is literals[offsets[j], offsets[j + 1])
+struct formula {
+    formula() : offsets(1, 0) {}
+
+    formula(std::initializer_list<std::initializer_list<int>> clauses) : formula() {
+        for (const auto &clause : clauses) {
+            for (const auto &l : clause) {
+                add(l);
+            }
+            close();
+        }
+    }
+
+    void add(int l) {
+        literals.push_back(l);
+        n = std::max(n, static_cast<std::size_t>(l > 0 ? l : -l));
+    }
+
+    void close() { offsets.push_back(literals.size()); }
+
+    std::size_t size() const { return offsets.size() - 1; }
+
+    struct clause {
+        const int *b, *e;
+
+        const int *begin() const { return b; }
+
+        const int *end() const { return e; }
+
+        std::size_t size() const { return e - b; }
+    };
+
+    clause operator[](std::size_t j) const {
+        return {literals.data() + offsets[j], literals.data() + offsets[j + 1]};
+    }
+
+    std::size_t n = 0;
+    std::vector<int> literals;
+    std::vector<std::size_t> offsets;
+};
+
+// read-only view of a whole file: mmap for regular files, a plain read loop
+// for pipes and terminals (stdin)
+class mapped_file {
+public:
+    explicit mapped_file(const std::string &path) {
+        const auto fd(path == "-" ? 0 : ::open(path.c_str(), O_RDONLY));
+        if (fd < 0) {
+            throw std::runtime_error(path + ": cannot open");
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            const auto p(::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+            if (p != MAP_FAILED) {
+                ::madvise(p, st.st_size, MADV_SEQUENTIAL);
+                map = static_cast<const char *>(p);
+                length = st.st_size;
+            }
+        }
+        if (!map) {
+            char chunk[1 << 16];
+            for (ssize_t r; (r = ::read(fd, chunk, sizeof(chunk))) != 0;) {
+                if (r < 0) {
+                    if (fd) {
+                        ::close(fd);
+                    }
+                    throw std::runtime_error(path + ": read error");
+                }
+                copy.append(chunk, r);
+            }
+        }
+        if (fd) {
+            ::close(fd);
+        }
+    }
+
+    mapped_file(const mapped_file &) = delete;
+
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    ~mapped_file() {
+        if (map) {
+            ::munmap(const_cast<char *>(map), length);
+        }
+    }
+
+    const char *begin() const { return map ? map : copy.data(); }
+
+    const char *end() const { return begin() + (map ? length : copy.size()); }
+
+private:
+    const char *map = nullptr;
+    std::size_t length = 0;
+    std::string copy;
+};
+
+// DIMACS cnf: 'c' comment lines, an optional "p cnf <vars> <clauses>" header,
+// zero-terminated clauses of any width, '%' ends the input (SATLIB files)
+inline formula parse_dimacs(const char *p, const char *end) {
+    formula cnf;
+    std::size_t line(1), open(0);
+    auto fail = [&](const std::string &what) {
+        throw std::runtime_error("dimacs line " + std::to_string(line) + ": " + what);
+    };
+    auto number = [&]() {
+        const auto negative(p != end && *p == '-');
+        p += p != end && (negative || *p == '+');
+        if (p == end || *p < '0' || *p > '9') {
+            fail("expected a number");
+        }
+        long v(0);
+        for (; p != end && *p >= '0' && *p <= '9'; p++) {
+            v = 10 * v + (*p - '0');
+            if (v > 0x7fffffff) {
+                fail("number out of range");
+            }
+        }
+        return negative ? -v : v;
+    };
+    auto skip_line = [&]() {
+        while (p != end && *p != '\n') {
+            p++;
+        }
+    };
+    while (p != end) {
+        switch (*p) {
+            case '\n':
+                line++;
+                [[fallthrough]];
+            case ' ':
+            case '\t':
+            case '\r':
+                p++;
+                break;
+            case 'c':
+                skip_line();
+                break;
+            case '%':
+                p = end;
+                break;
+            case 'p': {
+                p++;
+                while (p != end && (*p == ' ' || *p == '\t')) {
+                    p++;
+                }
+                if (end - p < 3 || std::string(p, 3) != "cnf") {
+                    fail("expected \"p cnf\"");
+                }
+                p += 3;
+                while (p != end && (*p == ' ' || *p == '\t')) {
+                    p++;
+                }
+                cnf.n = std::max<std::size_t>(cnf.n, number());
+                while (p != end && (*p == ' ' || *p == '\t')) {
+                    p++;
+                }
+                const auto m(number());
+                // a clause takes at least its "0" and a separator
+                cnf.offsets.reserve(std::min<std::size_t>(m, (end - p) / 2) + 1);
+                cnf.literals.reserve(std::min<std::size_t>((end - p) / 2, 3 * m + 1));
+                break;
+            }
+            default: {
+                const auto l(number());
+                if (l) {
+                    cnf.add(static_cast<int>(l));
+                    open++;
+                } else {
+                    cnf.close();
+                    open = 0;
+                }
+            }
+        }
+    }
+    if (open) {
+        cnf.close();
+    }
+    return cnf;
+}
+
+inline formula load_dimacs(const std::string &path) {
+    const mapped_file file(path);
+    return parse_dimacs(file.begin(), file.end());
+}
+
+#endif
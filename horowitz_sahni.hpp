@@ -0,0 +1,205 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_HOROWITZ_SAHNI_HPP
+#define UNT_HOROWITZ_SAHNI_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "arena.hpp"
+#include "limbs.hpp"
+#include "phi.hpp"
+
+// exact subset sum, Horowitz & Sahni (1974): every subset sum of each half of
+// the universe, both lists sorted, and one merge pass finds the pairs that
+// add up to t. unlike abstract_binary_search it does not rely on phi being
+// monotone, so it never misses a solution; it pays 2^(m/2) rows per half.
+
+// sorted runs on every thread, then pairwise merges
+template<typename It, typename C>
+void parallel_sort(It b, It e, C cmp) {
+#ifdef _OPENMP
+    const std::ptrdiff_t n(e - b);
+    const int p(omp_get_max_threads());
+    if (p > 1 && n > (1 << 16)) {
+        std::vector<std::ptrdiff_t> cut(p + 1);
+        for (int i(0); i <= p; i++) {
+            cut[i] = n * i / p;
+        }
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < p; i++) {
+            std::sort(b + cut[i], b + cut[i + 1], cmp);
+        }
+        for (int width(1); width < p; width *= 2) {
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < p; i += 2 * width) {
+                if (i + width < p) {
+                    std::inplace_merge(b + cut[i], b + cut[i + width], b + cut[std::min(i + 2 * width, p)], cmp);
+                }
+            }
+        }
+        return;
+    }
+#endif
+    std::sort(b, e, cmp);
+}
+
+inline int compare_rows(const word *a, const word *b, std::size_t stride) {
+    for (auto i(stride); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// all 2^len subset sums of universe[base, base + len), stride words per row.
+// row x is row x - 2^b plus term b (b its top bit), so each power-of-two block of
+// rows is built in parallel from the blocks below it.
+template<typename U, typename T>
+scratch_vector<word> subset_sums(const scratch_vector<U> &universe, std::size_t base, std::size_t len, const T &zero) {
+    const auto stride(zero.size());
+    scratch_vector<word> rows((std::size_t(1) << len) * stride, 0);
+#pragma omp parallel
+    {
+        T s(zero);
+        for (std::size_t bit(0); bit < len; bit++) {
+            const std::ptrdiff_t lo(std::ptrdiff_t(1) << bit), hi(lo << 1);
+#pragma omp for schedule(static)
+            for (std::ptrdiff_t x = lo; x < hi; x++) {
+                s.assign(rows.data() + (x - lo) * stride);
+                accumulate(s, universe[base + bit]);
+                std::copy(s.data(), s.data() + stride, rows.data() + x * stride);
+            }
+        }
+    }
+    return rows;
+}
+
+// the k least of matches, in increasing order
+template<typename N>
+void least(std::vector<N> &matches, std::size_t k) {
+    auto less = [](const N &x, const N &y) { return x < y; };
+    if (matches.size() > k) {
+        std::nth_element(matches.begin(), matches.begin() + k, matches.end(), less);
+        matches.resize(k);
+    }
+    std::sort(matches.begin(), matches.end(), less);
+}
+
+// the k least (0: all) indices n with phi(n, universe) == t, how many there
+// are in total, and the work done: rows generated plus merge steps. the merge
+// meets them in no useful order, so every match is weighed: the list is cut
+// back to the k least whenever it holds 2 k
+template<typename N, typename U, typename T>
+std::tuple<std::vector<N>, word, word> horowitz_sahni(const scratch_vector<U> &universe, const T &t, std::size_t k = 0) {
+    const auto m(universe.size());
+    const auto la(m / 2), lb(m - la);
+    const auto stride(t.size());
+    if (lb > 30 || ((std::size_t(1) << la) + (std::size_t(1) << lb)) * stride * sizeof(word) > available_memory()) {
+        throw std::runtime_error("horowitz-sahni: 2^" + std::to_string(lb) + " subset sums per half do not fit in memory");
+    }
+
+    auto a(subset_sums(universe, 0, la, t));
+    auto b(subset_sums(universe, la, lb, t));
+
+    // b -> t - b, so the merge looks for equal rows; sums above t never match
+    struct entry {
+        word key;
+        word row;
+    };
+    std::size_t top(stride);
+    while (top > 1 && !t[top - 1]) {
+        top--;
+    }
+    top--;
+    scratch_vector<entry> ea, eb;
+    ea.reserve(std::size_t(1) << la);
+    eb.reserve(std::size_t(1) << lb);
+    for (word x(0); x < (word(1) << la); x++) {
+        const auto r(a.data() + x * stride);
+        if (compare_rows(r, t.data(), stride) <= 0) {
+            ea.push_back({r[top], x});
+        }
+    }
+    for (word x(0); x < (word(1) << lb); x++) {
+        const auto r(b.data() + x * stride);
+        word borrow(0);
+        for (std::size_t i(0); i < stride; i++) {
+            word d;
+            const bool p(__builtin_sub_overflow(t[i], r[i], &d));
+            const bool q(__builtin_sub_overflow(d, borrow, &r[i]));
+            borrow = p | q;
+        }
+        if (!borrow) {
+            eb.push_back({r[top], x});
+        }
+    }
+
+    auto by = [stride](const scratch_vector<word> &rows) {
+        return [&rows, stride](const entry &x, const entry &y) {
+            return x.key != y.key ? x.key < y.key : compare_rows(rows.data() + x.row * stride, rows.data() + y.row * stride, stride) < 0;
+        };
+    };
+    parallel_sort(ea.begin(), ea.end(), by(a));
+    parallel_sort(eb.begin(), eb.end(), by(b));
+
+    std::vector<N> matches;
+    word count(0), complexity(a.size() / stride + b.size() / stride);
+    for (std::size_t p(0), q(0); p < ea.size() && q < eb.size();) {
+        complexity++;
+        const auto c(ea[p].key != eb[q].key ? (ea[p].key < eb[q].key ? -1 : 1)
+                                            : compare_rows(a.data() + ea[p].row * stride, b.data() + eb[q].row * stride, stride));
+        if (c < 0) {
+            p++;
+        } else if (c > 0) {
+            q++;
+        } else {
+            auto[pe, qe] = std::make_pair(p + 1, q + 1);
+            while (pe < ea.size() && !compare_rows(a.data() + ea[pe].row * stride, a.data() + ea[p].row * stride, stride)) {
+                pe++;
+            }
+            while (qe < eb.size() && !compare_rows(b.data() + eb[qe].row * stride, b.data() + eb[q].row * stride, stride)) {
+                qe++;
+            }
+            count += (pe - p) * (qe - q);
+            for (auto i(p); i < pe; i++) {
+                for (auto j(q); j < qe; j++) {
+                    N n(m + 1);
+                    for (std::size_t bit(0); bit < la; bit++) {
+                        if ((ea[i].row >> bit) & 1) {
+                            n.set(bit);
+                        }
+                    }
+                    for (std::size_t bit(0); bit < lb; bit++) {
+                        if ((eb[j].row >> bit) & 1) {
+                            n.set(la + bit);
+                        }
+                    }
+                    matches.push_back(n);
+                    if (k && matches.size() >= 2 * k) {
+                        least(matches, k);
+                    }
+                }
+            }
+            std::tie(p, q) = std::make_pair(pe, qe);
+        }
+    }
+    least(matches, k ? k : matches.size());
+    return std::make_tuple(matches, count, complexity);
+}
+
+#endif
@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_INCREMENTAL_HPP
+#define UNT_INCREMENTAL_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arena.hpp"
+#include "dimacs.hpp"
+#include "limbs.hpp"
+#include "table.hpp"
+
+// a formula kept solved across clause edits. the universe is laid out as in
+// sat_equation, one term per clause slot; a removed clause leaves a zero term
+// in its slot, which the next add reuses, so the bits of a universal index
+// keep their meaning. a tautology has a zero term too, so live marks the
+// slots that hold a clause.
+//
+// add ORs one cube into the table. remove clears its cube and ORs back what the
+// other clauses cover of it: one intersection test per clause plus the words
+// of the cube, never the whole table.
+//
+// the last universal index is carried across edits with its sum: an added
+// clause sets its bit, a removed one clears it. when the cube of the edit does
+// not overlap the rest of the table that index still matches, and warm() finds
+// it without a search. search bounds found against an older table say nothing
+// about the new one, so nothing else is reused.
+//
+// all of it lives across solves, so it is kept on the heap (arena heap_scope):
+// in the arena it would keep the scratch of every solve from being reused.
+template<typename T>
+class incremental_sat {
+public:
+    // zero: the width of the table and of the sums, carries included
+    incremental_sat(const formula &cnf, const T &zero) : incremental_sat(cnf, zero, arena::heap_scope()) {}
+
+    // the slot of the new clause
+    template<typename C>
+    std::size_t add(const C &clause) {
+        for (const auto &l : clause) {
+            if (!l || static_cast<std::size_t>(l > 0 ? l : -l) > n) {
+                throw std::runtime_error("clause literal " + std::to_string(l) + " outside 1.." + std::to_string(n));
+            }
+        }
+        arena::heap_scope heap;
+        const auto c(clause_term(clause, n));
+        std::size_t id(slots());
+        if (vacant.empty()) {
+            terms.push_back(c);
+            live.push_back(1);
+        } else {
+            id = vacant.back();
+            vacant.pop_back();
+            terms[id] = c;
+            live[id] = 1;
+        }
+        if (c.low) {
+            or_enumerate(sat.data(), table_words(n), c);
+        }
+        if (found) {
+            grow(id + 1);
+            last.set(id);
+            accumulate(sum, c);
+        }
+        return id;
+    }
+
+    void remove(std::size_t id) {
+        if (id >= slots() || !live[id]) {
+            throw std::runtime_error("no clause " + std::to_string(id));
+        }
+        const auto c(terms[id]);
+        terms[id] = cube_words{0, 0, 0};
+        live[id] = 0;
+        vacant.push_back(id);
+        if (c.low) {
+            clear_enumerate(sat.data(), table_words(n), c);
+        }
+        for (const auto &o : terms) {
+            if (o.low & c.low && !((o.value ^ c.value) & o.care & c.care)) {
+                or_enumerate(sat.data(), table_words(n), cube_words{o.low & c.low, o.care | c.care, o.value | c.value});
+            }
+        }
+        if (found && last.test(id)) {
+            last.reset(id);
+            retract(sum, c);
+        }
+    }
+
+    const T &table() const { return sat; }
+
+    const scratch_vector<cube_words> &universe() const { return terms; }
+
+    // clause slots, live or free
+    std::size_t slots() const { return terms.size(); }
+
+    std::size_t variables() const { return n; }
+
+    // the carried index, if its sum is the table
+    template<typename N>
+    bool warm(N &index) const {
+        if (!found || sum != sat) {
+            return false;
+        }
+        index = N(terms.size() + 1);
+        for (std::size_t i(0); i < std::min(index.size(), last.size()); i++) {
+            index[i] = last[i];
+        }
+        return true;
+    }
+
+    // the index a search found, and its sum
+    template<typename N>
+    void remember(const N &index, const T &s) {
+        arena::heap_scope heap;
+        last = limbs<0>(64 * index.size());
+        for (std::size_t i(0); i < index.size(); i++) {
+            last[i] = index[i];
+        }
+        sum = s;
+        found = true;
+    }
+
+    void forget() { found = false; }
+
+private:
+    // built while the scope is open
+    incremental_sat(const formula &cnf, const T &zero, const arena::heap_scope &) : n(cnf.n), sat(zero), sum(zero) {
+        terms.reserve(cnf.size());
+        for (std::size_t j(0); j < cnf.size(); j++) {
+            terms.emplace_back(clause_term(cnf[j], n));
+        }
+        live.assign(cnf.size(), 1);
+        falsification_table(terms, n, sat);
+    }
+
+    void grow(std::size_t bits) {
+        if (64 * last.size() < bits) {
+            limbs<0> wider(bits);
+            for (std::size_t i(0); i < last.size(); i++) {
+                wider[i] = last[i];
+            }
+            last = wider;
+        }
+    }
+
+    std::size_t n;
+    T sat, sum;
+    scratch_vector<cube_words> terms;
+    std::vector<char> live;
+    std::vector<std::size_t> vacant;
+    limbs<0> last;
+    bool found = false;
+};
+
+#endif
@@ -0,0 +1,317 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_LIMBS_HPP
+#define UNT_LIMBS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "arena.hpp"
+#include "profile.hpp"
+
+// multi-limb unsigned integer / bitset, 64-bit words, least significant first.
+// limbs<W> keeps W words inline (compile-time width), limbs<0> sizes itself at
+// runtime, in the arena of the thread; both expose the same interface so the
+// solver is written once.
+
+using word = std::uint64_t;
+
+template<std::size_t W>
+struct limb_storage {
+    explicit limb_storage(std::size_t) {}
+
+    static constexpr std::size_t size() { return W; }
+
+    word *data() { return w.data(); }
+
+    const word *data() const { return w.data(); }
+
+    std::array<word, W> w{};
+};
+
+template<>
+struct limb_storage<0> {
+    explicit limb_storage(std::size_t words) : w(std::max<std::size_t>(words, 1), 0) {}
+
+    std::size_t size() const { return w.size(); }
+
+    word *data() { return w.data(); }
+
+    const word *data() const { return w.data(); }
+
+    scratch_vector<word> w;
+};
+
+template<std::size_t W>
+class limbs {
+public:
+    // width in bits, rounded up to whole words (ignored by the fixed forms)
+    explicit limbs(std::size_t width = 64) : s((width + 63) / 64) {}
+
+    static limbs ones(std::size_t k, std::size_t width) {
+        limbs r(width);
+        for (std::size_t i(0); i < k / 64; i++) {
+            r[i] = ~word(0);
+        }
+        if (k % 64) {
+            r[k / 64] = (word(1) << (k % 64)) - 1;
+        }
+        return r;
+    }
+
+    static limbs pow2(std::size_t k, std::size_t width) {
+        limbs r(width);
+        r.set(k);
+        return r;
+    }
+
+    std::size_t size() const { return s.size(); }
+
+    word *data() { return s.data(); }
+
+    const word *data() const { return s.data(); }
+
+    word &operator[](std::size_t i) { return s.data()[i]; }
+
+    const word &operator[](std::size_t i) const { return s.data()[i]; }
+
+    void clear() { std::fill(data(), data() + size(), word(0)); }
+
+    bool test(std::size_t k) const {
+        return k / 64 < size() && ((*this)[k / 64] >> (k % 64)) & 1;
+    }
+
+    void set(std::size_t k) { (*this)[k / 64] |= word(1) << (k % 64); }
+
+    void reset(std::size_t k) { (*this)[k / 64] &= ~(word(1) << (k % 64)); }
+
+    // += 2^k, carry propagates into the higher words
+    void add_pow2(std::size_t k) { add_word(word(1) << (k % 64), k / 64); }
+
+    void increment() { add_word(1, 0); }
+
+    limbs &operator+=(word v) {
+        add_word(v, 0);
+        return *this;
+    }
+
+    limbs &operator+=(const limbs &o) {
+        profile_count(LIMB_OPS);
+        const auto k(std::min(size(), o.size()));
+        word c(0);
+        for (std::size_t i(0); i < k; i++) {
+            word r;
+            const bool a(__builtin_add_overflow((*this)[i], o[i], &r));
+            const bool b(__builtin_add_overflow(r, c, &(*this)[i]));
+            c = a | b;
+        }
+        if (c && k < size()) {
+            add_word(c, k);
+        }
+        return *this;
+    }
+
+    limbs &operator-=(word v) {
+        sub_word(v, 0);
+        return *this;
+    }
+
+    limbs &operator-=(const limbs &o) {
+        profile_count(LIMB_OPS);
+        const auto k(std::min(size(), o.size()));
+        word b(0);
+        for (std::size_t i(0); i < k; i++) {
+            word r;
+            const bool x(__builtin_sub_overflow((*this)[i], o[i], &r));
+            const bool y(__builtin_sub_overflow(r, b, &(*this)[i]));
+            b = x | y;
+        }
+        if (b && k < size()) {
+            sub_word(b, k);
+        }
+        return *this;
+    }
+
+    // the same operations against size() raw words (a row of a flat table)
+    void assign(const word *p) { std::copy(p, p + size(), data()); }
+
+    void add(const word *p) {
+        profile_count(LIMB_OPS);
+        word c(0);
+        for (std::size_t i(0); i < size(); i++) {
+            word r;
+            const bool a(__builtin_add_overflow((*this)[i], p[i], &r));
+            const bool b(__builtin_add_overflow(r, c, &(*this)[i]));
+            c = a | b;
+        }
+    }
+
+    // bits [pos, pos + len) as a word, len <= 64
+    word extract(std::size_t pos, std::size_t len) const {
+        const auto i(pos / 64), o(pos % 64);
+        word r(i < size() ? (*this)[i] >> o : 0);
+        if (o && i + 1 < size()) {
+            r |= (*this)[i + 1] << (64 - o);
+        }
+        return len < 64 ? r & ((word(1) << len) - 1) : r;
+    }
+
+    // *= v, returns the word carried out of the top
+    word mul_word(word v) {
+        profile_count(LIMB_OPS);
+        word c(0);
+        for (std::size_t i(0); i < size(); i++) {
+            const auto r(static_cast<unsigned __int128>((*this)[i]) * v + c);
+            (*this)[i] = static_cast<word>(r);
+            c = static_cast<word>(r >> 64);
+        }
+        return c;
+    }
+
+    // /= v, returns the remainder
+    word div_word(word v) {
+        profile_count(LIMB_OPS);
+        unsigned __int128 r(0);
+        for (auto i(size()); i-- > 0;) {
+            r = (r << 64) | (*this)[i];
+            (*this)[i] = static_cast<word>(r / v);
+            r %= v;
+        }
+        return static_cast<word>(r);
+    }
+
+    // /= 2
+    void halve() {
+        profile_count(LIMB_OPS);
+        for (std::size_t i(0); i < size(); i++) {
+            (*this)[i] = ((*this)[i] >> 1) | (i + 1 < size() ? (*this)[i + 1] << 63 : 0);
+        }
+    }
+
+    std::size_t popcount() const {
+        std::size_t c(0);
+        for (std::size_t i(0); i < size(); i++) {
+            c += __builtin_popcountll((*this)[i]);
+        }
+        return c;
+    }
+
+    friend int compare(const limbs &a, const limbs &b) {
+        profile_count(LIMB_OPS);
+        for (std::size_t i(std::max(a.size(), b.size())); i-- > 0;) {
+            const word x(i < a.size() ? a[i] : 0), y(i < b.size() ? b[i] : 0);
+            if (x != y) {
+                return x < y ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    friend bool operator<(const limbs &a, const limbs &b) { return compare(a, b) < 0; }
+
+    friend bool operator>(const limbs &a, const limbs &b) { return compare(a, b) > 0; }
+
+    friend bool operator==(const limbs &a, const limbs &b) { return compare(a, b) == 0; }
+
+    friend bool operator!=(const limbs &a, const limbs &b) { return compare(a, b) != 0; }
+
+    // decimal, by repeated division with 10^19 chunks
+    std::string str() const {
+        scratch_vector<word> q(data(), data() + size());
+        std::string r;
+        auto top(q.size());
+        while (top && !q[top - 1]) {
+            top--;
+        }
+        while (top) {
+            unsigned __int128 rem(0);
+            for (auto i(top); i-- > 0;) {
+                const auto cur((rem << 64) | q[i]);
+                q[i] = static_cast<word>(cur / 10000000000000000000ull);
+                rem = cur % 10000000000000000000ull;
+            }
+            while (top && !q[top - 1]) {
+                top--;
+            }
+            auto chunk(static_cast<word>(rem));
+            for (int d(0); d < 19 && (top || chunk); d++) {
+                r.push_back("0123456789"[chunk % 10]);
+                chunk /= 10;
+            }
+        }
+        if (r.empty()) {
+            r = "0";
+        }
+        std::reverse(r.begin(), r.end());
+        return r;
+    }
+
+    // += v * 2^(64 i)
+    void add_word(word v, std::size_t i) {
+        profile_count(LIMB_OPS);
+        for (; v && i < size(); i++) {
+            v = __builtin_add_overflow((*this)[i], v, &(*this)[i]);
+        }
+    }
+
+    // -= v * 2^(64 i)
+    void sub_word(word v, std::size_t i) {
+        profile_count(LIMB_OPS);
+        for (; v && i < size(); i++) {
+            v = __builtin_sub_overflow((*this)[i], v, &(*this)[i]);
+        }
+    }
+
+private:
+    limb_storage<W> s;
+};
+
+template<std::size_t W>
+void accumulate(limbs<W> &s, const limbs<W> &v) { s += v; }
+
+template<std::size_t W>
+void accumulate(limbs<W> &s, word v) { s += v; }
+
+template<std::size_t W>
+void retract(limbs<W> &s, const limbs<W> &v) { s -= v; }
+
+template<std::size_t W>
+void retract(limbs<W> &s, word v) { s -= v; }
+
+// words touched by one accumulate, for the cost models
+template<std::size_t W>
+std::size_t term_words(const limbs<W> &s, const limbs<W> &) { return s.size(); }
+
+template<std::size_t W>
+std::size_t term_words(const limbs<W> &, word) { return 1; }
+
+// calls f(limbs<W>(width)) with the narrowest fixed W that holds width bits,
+// falling back to the dynamic form past 576 bits. the steps are a table of
+// 2^n bits, n <= 9, with the carry word of its sums (table.hpp sum_width)
+template<typename F>
+void with_limbs(std::size_t width, F &&f) {
+    if (width <= 64) {
+        f(limbs<1>(width));
+    } else if (width <= 128) {
+        f(limbs<2>(width));
+    } else if (width <= 192) {
+        f(limbs<3>(width));
+    } else if (width <= 320) {
+        f(limbs<5>(width));
+    } else if (width <= 576) {
+        f(limbs<9>(width));
+    } else {
+        f(limbs<0>(width));
+    }
+}
+
+#endif
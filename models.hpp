@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_MODELS_HPP
+#define UNT_MODELS_HPP
+
+#include <cstddef>
+#include <iterator>
+
+#include "limbs.hpp"
+#include "table.hpp"
+
+// lazy view of a table, nothing of size 2^n is ever allocated.
+//
+// model_range walks the models of a falsification table, the indices k whose
+// bit is clear, in increasing k: one count-trailing-zeros per model and one
+// load per 64 assignments. k is a table index (bit n - v set: v false).
+
+template<typename T>
+class model_range {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = word;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = word;
+
+        // the first model at or after word w
+        iterator(const model_range *r, std::size_t w) : r(r), w(w) {
+            if (w < r->words) {
+                x = r->free(w);
+                skip();
+            }
+        }
+
+        word operator*() const { return 64 * w + __builtin_ctzll(x); }
+
+        iterator &operator++() {
+            x &= x - 1;
+            if (++taken == r->limit) {
+                w = r->words;
+                return *this;
+            }
+            skip();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto r(*this);
+            ++*this;
+            return r;
+        }
+
+        bool operator==(const iterator &o) const { return w == o.w && (w == r->words || x == o.x); }
+
+        bool operator!=(const iterator &o) const { return !(*this == o); }
+
+    private:
+        void skip() {
+            while (!x && ++w < r->words) {
+                x = r->free(w);
+            }
+        }
+
+        const model_range *r;
+        std::size_t w;
+        word x = 0;
+        std::size_t taken = 0;
+    };
+
+    // limit: stop after that many models (0: all of them)
+    model_range(const T &table, const std::size_t &n, std::size_t limit = 0)
+            : table(table), words(table_words(n)), tail(n < 6 ? (word(1) << (std::size_t(1) << n)) - 1 : ~word(0)), limit(limit) {}
+
+    iterator begin() const { return iterator(this, 0); }
+
+    iterator end() const { return iterator(this, words); }
+
+private:
+    word free(std::size_t w) const { return ~table[w] & tail; }
+
+    const T &table;
+    std::size_t words;
+    word tail;
+    std::size_t limit;
+};
+
+template<typename T>
+model_range<T> models(const T &table, const std::size_t &n, std::size_t limit = 0) {
+    return model_range<T>(table, n, limit);
+}
+
+#endif
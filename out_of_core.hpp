@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_OUT_OF_CORE_HPP
+#define UNT_OUT_OF_CORE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "arena.hpp"
+#include "cube_and_conquer.hpp"
+#include "dimacs.hpp"
+#include "limbs.hpp"
+#include "models.hpp"
+#include "table.hpp"
+#include "writer.hpp"
+
+// out-of-core sat space: the 2^n bit table lives in a file mapped shared, and
+// everything that walks it (build, count, print, search) goes slice by slice,
+// handing each slice back to the page cache before touching the next, so the
+// resident set stays near one slice whatever n is. slices are the cube and
+// conquer slices over the top variables.
+
+class mapped_table {
+public:
+    // an unlinked file under dir, 2^n bits of zeros
+    mapped_table(const std::string &dir, const std::size_t &n) : words(table_words(n)) {
+        auto path(dir + "/unt.XXXXXX");
+        fd = ::mkstemp(&path[0]);
+        if (fd < 0) {
+            throw std::runtime_error(dir + ": cannot create the table file");
+        }
+        ::unlink(path.c_str());
+        const auto p(::ftruncate(fd, bytes()) ? MAP_FAILED : ::mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error(dir + ": cannot map " + std::to_string(bytes()) + " bytes");
+        }
+        d = static_cast<word *>(p);
+    }
+
+    mapped_table(const mapped_table &) = delete;
+
+    mapped_table &operator=(const mapped_table &) = delete;
+
+    ~mapped_table() {
+        ::munmap(d, bytes());
+        ::close(fd);
+    }
+
+    std::size_t size() const { return words; }
+
+    std::size_t bytes() const { return words * sizeof(word); }
+
+    word *data() { return d; }
+
+    const word *data() const { return d; }
+
+    word &operator[](std::size_t i) { return d[i]; }
+
+    const word &operator[](std::size_t i) const { return d[i]; }
+
+    bool test(std::size_t k) const { return (d[k / 64] >> (k % 64)) & 1; }
+
+    // starts writing back words [first, first + count) and drops them from the
+    // resident set; first is a slice start, so page aligned
+    void release(std::size_t first, std::size_t count) const {
+        const auto offset(first * sizeof(word)), length(count * sizeof(word));
+        ::sync_file_range(fd, offset, length, SYNC_FILE_RANGE_WRITE);
+        ::madvise(reinterpret_cast<char *>(d) + offset, length, MADV_DONTNEED);
+    }
+
+private:
+    std::size_t words;
+    int fd;
+    word *d;
+};
+
+// top variables fixed per slice: the fewest that bring a slice under
+// `resident` bytes, but slices no smaller than a page
+inline std::size_t slice_vars(const std::size_t &n, const std::size_t &resident) {
+    std::size_t k(0);
+    while (n - k > 15 && (table_words(n - k) * sizeof(word)) > resident) {
+        k++;
+    }
+    return k;
+}
+
+// the falsification table of cnf, one slice at a time
+inline void build_mapped_table(const formula &cnf, const std::size_t &n, const std::size_t &k, mapped_table &table) {
+    const auto rest(n - k);
+    const auto slice(table_words(rest));
+    scratch_vector<cube_words> clauses;
+    for (word h(0); h < (word(1) << k); h++) {
+        simplify(cnf, n, k, h, clauses);
+        table_view view{table.data() + h * slice, slice};
+        falsification_table(clauses, rest, view);
+        table.release(h * slice, slice);
+    }
+}
+
+inline word mapped_count(const mapped_table &table, const std::size_t &n, const std::size_t &k) {
+    const auto slice(table_words(n - k));
+    word c(0);
+    for (std::size_t lo(0); lo < table.size(); lo += slice) {
+#pragma omp parallel for reduction(+:c) schedule(static)
+        for (std::ptrdiff_t w = 0; w < static_cast<std::ptrdiff_t>(slice); w++) {
+            c += __builtin_popcountll(table[lo + w]);
+        }
+        table.release(lo, slice);
+    }
+    return (word(1) << n) - c;
+}
+
+// the SAT SPACE line body: bit k of the table, negated, from k = 2^n - 1 down
+inline void print_mapped(const mapped_table &table, const std::size_t &n, const std::size_t &k, writer &out, BITS form) {
+    const auto slice(table_words(n - k));
+    const auto bits(std::min<std::size_t>(64, std::size_t(1) << n));
+    for (auto lo(table.size()); lo > 0;) {
+        lo -= slice;
+        for (auto w(lo + slice); w-- > lo;) {
+            out.negated(table[w], bits, ORDER::INVERSE, form);
+        }
+        table.release(lo, slice);
+    }
+}
+
+// f(x) for the models of the table in increasing index, at most limit of them
+// (0: all), slice by slice
+template<typename F>
+void mapped_models(const mapped_table &table, const std::size_t &n, const std::size_t &k, std::size_t limit, F &&f) {
+    const auto rest(n - k);
+    const auto slice(table_words(rest));
+    std::size_t seen(0);
+    for (std::size_t lo(0); lo < table.size() && (!limit || seen < limit); lo += slice) {
+        const table_view view{const_cast<word *>(table.data()) + lo, slice};
+        for (const auto &x : models(view, rest, limit ? limit - seen : 0)) {
+            f((word(lo / slice) << rest) | x);
+            seen++;
+        }
+        table.release(lo, slice);
+    }
+}
+
+// sign of phi(n, universe) - t without a 2^n bit sum: phi is summed one slice
+// at a time from the low end, the carry out of a slice being the only state
+// (it is below m), and the highest word that differs from t decides. a carry
+// out of the top slice is a sum past 2^n bits, above any t
+template<typename N>
+int mapped_compare(const N &n, const scratch_vector<cube_words> &universe, const mapped_table &t, const std::size_t &k, std::vector<word> &s) {
+    const auto slice(t.size() >> k);
+    s.resize(slice);
+    int sign(0);
+    word carry(0);
+    auto add = [&](word v, std::size_t i) {
+        for (; v && i < slice; i++) {
+            s[i] += v;
+            v = s[i] < v;
+        }
+        carry += v;
+    };
+    for (std::size_t lo(0); lo < t.size(); lo += slice) {
+        std::fill(s.begin(), s.end(), word(0));
+        const auto in(carry);
+        carry = 0;
+        add(in, 0);
+        for (std::size_t i(0); i < universe.size(); i++) {
+            const auto &c(universe[i]);
+            if (!c.low || !n.test(i) || (lo ^ c.value) & c.care & ~word(slice - 1)) {
+                continue;
+            }
+            const word free(~c.care & (slice - 1)), base(c.value & (slice - 1));
+            word x(0);
+            do {
+                add(c.low, base | x);
+                x = (x - free) & free;
+            } while (x);
+        }
+        for (std::size_t w(0); w < slice; w++) {
+            if (s[w] != t[lo + w]) {
+                sign = s[w] < t[lo + w] ? -1 : 1;
+            }
+        }
+        t.release(lo, slice);
+    }
+    return carry ? 1 : sign;
+}
+
+#endif
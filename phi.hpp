@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_PHI_HPP
+#define UNT_PHI_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+#include "arena.hpp"
+#include "limbs.hpp"
+
+// s = sum of universe[i] over the set bits i of n
+auto phi = [](const auto &n, const auto &universe, auto &s) {
+    s.clear();
+    for (std::size_t k(0); k < n.size(); k++) {
+        for (auto w(n[k]); w; w &= w - 1) {
+            const auto i(64 * k + __builtin_ctzll(w));
+            if (i >= universe.size()) {
+                return;
+            }
+            accumulate(s, universe[i]);
+        }
+    }
+};
+
+// how a probe is evaluated:
+//   SCAN   walks every set bit of the index (the plain phi above)
+//   DELTA  keeps the previous probe and only adds / retracts the flipped bits
+//   TABLES splits the index into chunks with precomputed subset sums, so a
+//          probe is one row lookup per chunk (two for meet in the middle)
+enum PHI {
+    AUTO,
+    SCAN,
+    DELTA,
+    TABLES
+};
+
+inline const char *phi_name(PHI mode) {
+    switch (mode) {
+        case SCAN:
+            return "scan";
+        case DELTA:
+            return "delta";
+        case TABLES:
+            return "tables";
+        default:
+            return "auto";
+    }
+}
+
+// half of the memory the kernel reports as free
+inline std::size_t available_memory() {
+    const auto pages(sysconf(_SC_AVPHYS_PAGES)), page(sysconf(_SC_PAGESIZE));
+    return pages > 0 && page > 0 ? static_cast<std::size_t>(pages) * page / 2 : std::size_t(1) << 30;
+}
+
+// copies share the tables and keep their own delta state and counters, so
+// each thread of a parallel search probes through its own copy
+template<typename N, typename U, typename T>
+class phi_engine {
+public:
+    // probes: how many evaluations the caller expects (0: a binary search, m + 1);
+    // budget: bytes the tables may take (0: available_memory()); chunks stay
+    // at or below 2^20 rows so the build never dwarfs the search
+    phi_engine(const scratch_vector<U> &universe, const T &zero, PHI mode = AUTO, std::size_t probes = 0, std::size_t budget = 0)
+            : mode(mode), universe(universe), prev(universe.size() + 1), last(zero), scratch(zero) {
+        const auto m(universe.size());
+        const auto stride(zero.size());
+        probes = probes ? probes : m + 1;
+        budget = budget ? budget : available_memory();
+
+        double tau(0);
+        for (const auto &u : universe) {
+            tau += term_words(zero, u);
+        }
+        tau = m ? std::max(tau / m, 1.0) : 1.0;
+
+        auto fits = [&](std::size_t c) {
+            const auto b((m + c - 1) / std::max<std::size_t>(c, 1));
+            return b <= 20 && c * (std::size_t(1) << b) * stride * sizeof(word) <= budget;
+        };
+
+        if (this->mode == AUTO) {
+            const double scan_cost(probes * (m / 2.0) * tau);
+            const double delta_cost((m / 2.0) * tau + probes * 2.0 * tau);
+            const double entries(m < 2 ? 2 : (std::size_t(1) << ((m + 1) / 2)) + (std::size_t(1) << (m / 2)));
+            const double table_cost(entries * (stride + tau) + probes * 2.0 * stride);
+            this->mode = delta_cost < scan_cost ? DELTA : SCAN;
+            if (m && fits(2) && table_cost < std::min(scan_cost, delta_cost)) {
+                this->mode = TABLES;
+            }
+        }
+
+        if (this->mode == TABLES && !m) {
+            this->mode = SCAN;
+        }
+
+        if (this->mode == TABLES) {
+            chunks = 1;
+            while (chunks < m && !fits(chunks)) {
+                chunks++;
+            }
+            chunk_bits = m ? (m + chunks - 1) / chunks : 1;
+            build(stride);
+        }
+    }
+
+    // s = phi(n, universe)
+    void operator()(const N &n, T &s) {
+        const auto start(std::chrono::steady_clock::now());
+        switch (mode) {
+            case TABLES:
+                lookup(n, s);
+                break;
+            case DELTA:
+                step(n, s);
+                break;
+            default:
+                phi(n, universe, s);
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+        calls++;
+        profile_count(PHI_CALLS);
+    }
+
+    PHI mode;
+    std::size_t chunks = 0, chunk_bits = 0;
+    std::size_t calls = 0;
+    std::chrono::nanoseconds elapsed{0};
+
+private:
+    // chunk k covers universe [k b, k b + len), row x of it is the sum of the
+    // subset x of that range; rows are stride words in one flat array
+    void build(std::size_t stride) {
+        const auto m(universe.size());
+        table = std::allocate_shared<scratch_vector<word>>(scratch_allocator<word>());
+        for (std::size_t k(0); k * chunk_bits < m; k++) {
+            const auto base(k * chunk_bits), len(std::min(chunk_bits, m - base));
+            offsets.push_back(table->size());
+            table->resize(table->size() + (std::size_t(1) << len) * stride, 0);
+            const auto rows(table->data() + offsets.back());
+            for (std::size_t x(1); x < (std::size_t(1) << len); x++) {
+                scratch.assign(rows + (x & (x - 1)) * stride);
+                accumulate(scratch, universe[base + __builtin_ctzll(x)]);
+                std::copy(scratch.data(), scratch.data() + stride, rows + x * stride);
+            }
+        }
+    }
+
+    void lookup(const N &n, T &s) {
+        const auto stride(s.size());
+        const auto m(universe.size());
+        auto row = [&](std::size_t k) {
+            const auto base(k * chunk_bits);
+            return table->data() + offsets[k] + n.extract(base, std::min(chunk_bits, m - base)) * stride;
+        };
+        s.assign(row(0));
+        for (std::size_t k(1); k < offsets.size(); k++) {
+            s.add(row(k));
+        }
+    }
+
+    void step(const N &n, T &s) {
+        if (!calls) {
+            phi(n, universe, last);
+        } else {
+            for (std::size_t k(0); k < n.size(); k++) {
+                for (auto w(n[k] ^ prev[k]); w; w &= w - 1) {
+                    const auto i(64 * k + __builtin_ctzll(w));
+                    if (i >= universe.size()) {
+                        break;
+                    }
+                    if (n.test(i)) {
+                        accumulate(last, universe[i]);
+                    } else {
+                        retract(last, universe[i]);
+                    }
+                }
+            }
+        }
+        prev = n;
+        s = last;
+    }
+
+    const scratch_vector<U> &universe;
+    N prev;
+    T last, scratch;
+    std::shared_ptr<scratch_vector<word>> table;
+    scratch_vector<std::size_t> offsets;
+};
+
+#endif
@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_POOL_HPP
+#define UNT_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads. run(count, f) calls f(0) ... f(count - 1)
+// across the workers and the calling thread, and returns when all are done.
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<std::size_t>(threads, 1);
+        for (std::size_t k(1); k < threads; k++) {
+            workers.emplace_back([this] { loop(); });
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto &w : workers) {
+            w.join();
+        }
+    }
+
+    std::size_t size() const { return workers.size() + 1; }
+
+    template<typename F>
+    void run(std::size_t count, F &&f) {
+        if (count == 1 || workers.empty()) {
+            for (std::size_t k(0); k < count; k++) {
+                f(k);
+            }
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return !active; });
+        job = std::ref(f);
+        total = count;
+        next = 0;
+        pending = count;
+        generation++;
+        lock.unlock();
+        wake.notify_all();
+        work();
+        lock.lock();
+        done.wait(lock, [this] { return !pending && !active; });
+        job = nullptr;
+    }
+
+private:
+    void work() {
+        for (std::size_t k; (k = next++) < total;) {
+            job(k);
+            if (pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    void loop() {
+        std::size_t seen(0);
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stop || generation != seen; });
+            if (stop) {
+                return;
+            }
+            seen = generation;
+            active++;
+            lock.unlock();
+            work();
+            lock.lock();
+            if (!--active) {
+                done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    std::function<void(std::size_t)> job;
+    std::atomic<std::size_t> next{0}, pending{0};
+    std::size_t total = 0, generation = 0, active = 0;
+    bool stop = false;
+};
+
+// work-stealing pool for independent jobs. submit() deals tasks round robin
+// onto per-worker deques; a worker takes its own deque from the front, in the
+// order submitted, and when it runs dry steals from the back of the others.
+// tasks so start about in submission order, and a batch can release its
+// ordered output as it goes. each task gets the index of the worker running
+// it, to pick that worker's scratch buffers.
+class task_pool {
+public:
+    using task = std::function<void(std::size_t)>;
+
+    explicit task_pool(std::size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<std::size_t>(threads, 1);
+        for (std::size_t k(0); k < threads; k++) {
+            queues.emplace_back(new queue);
+        }
+        for (std::size_t k(0); k < threads; k++) {
+            workers.emplace_back([this, k] { loop(k); });
+        }
+    }
+
+    task_pool(const task_pool &) = delete;
+
+    task_pool &operator=(const task_pool &) = delete;
+
+    ~task_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto &w : workers) {
+            w.join();
+        }
+    }
+
+    std::size_t size() const { return workers.size(); }
+
+    void submit(task t) {
+        auto &q(*queues[deal++ % queues.size()]);
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(std::move(t));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued++;
+            unfinished++;
+        }
+        wake.notify_one();
+    }
+
+    // blocks until every submitted task has run
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return !unfinished; });
+    }
+
+private:
+    struct queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    bool pop(std::size_t self, task &t) {
+        for (std::size_t k(0); k < queues.size(); k++) {
+            auto &q(*queues[(self + k) % queues.size()]);
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                if (k) {
+                    t = std::move(q.tasks.back());
+                    q.tasks.pop_back();
+                } else {
+                    t = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void loop(std::size_t self) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stop || queued; });
+                if (!queued) {
+                    return;
+                }
+                queued--;
+            }
+            task t;
+            while (!pop(self, t)) {
+                std::this_thread::yield();
+            }
+            t(self);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!--unfinished) {
+                idle.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+    std::atomic<std::size_t> deal{0};
+    std::size_t queued = 0, unfinished = 0;
+    bool stop = false;
+};
+
+#endif
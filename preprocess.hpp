@@ -0,0 +1,369 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_PREPROCESS_HPP
+#define UNT_PREPROCESS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "arena.hpp"
+#include "dimacs.hpp"
+#include "limbs.hpp"
+#include "table.hpp"
+
+// cnf simplification ahead of the exponential encoding: unit propagation,
+// pure literals, tautologies, duplicates and subsumption, and bounded variable
+// elimination. every clause the reduced formula F' keeps is implied by F, and
+// every clause of F is either subsumed by one in F' or moved to the removed
+// set R, so the original table is
+//
+//     T(F) = expand(T(F')) | T(R)
+//
+// where expand reads the bits of the variables F' kept. that identity is what
+// lets report print SAT SPACE and UNIVERSAL in the original variables.
+
+// a clause over at most 64 variables: variable v is bit v - 1 of pos or neg
+struct clause_bits {
+    word pos;
+    word neg;
+
+    word vars() const { return pos | neg; }
+
+    std::size_t size() const { return __builtin_popcountll(pos) + __builtin_popcountll(neg); }
+
+    bool subsumes(const clause_bits &c) const { return !(pos & ~c.pos) && !(neg & ~c.neg); }
+};
+
+struct reconstruction {
+    static constexpr std::size_t none = ~std::size_t(0);
+
+    std::size_t n = 0, m = 0;                // the original formula
+    std::vector<std::size_t> kept;           // variable v of F' is kept[v - 1] of F
+    formula removed;                         // R, in the original variables, in removal order
+    std::vector<int> witness;                // the literal each clause of R was removed on
+    std::vector<std::size_t> origin;         // clause j of F' came from clause origin[j] of F (none: a resolvent)
+    std::size_t units = 0, pure = 0, subsumed = 0, eliminated = 0;
+
+    // index bits of F (bit n - v for variable v) that F' reads
+    word mask() const {
+        word r(0);
+        for (const auto &v : kept) {
+            r |= word(1) << (n - v);
+        }
+        return r;
+    }
+
+    // T(F) from T(F'), 2^n bits
+    template<typename T>
+    limbs<0> expand(const T &reduced) const {
+        limbs<0> full(std::size_t(1) << n);
+        scratch_vector<cube_words> r;
+        for (std::size_t j(0); j < removed.size(); j++) {
+            r.emplace_back(clause_term(removed[j], n));
+        }
+        falsification_table(r, n, full);
+        const auto select(mask());
+        const auto bits(std::min<std::size_t>(64, std::size_t(1) << n));
+#pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t w = 0; w < static_cast<std::ptrdiff_t>(table_words(n)); w++) {
+            word x(0);
+            for (std::size_t b(0); b < bits; b++) {
+                x |= word(reduced.test(extract(64 * w + b, select))) << b;
+            }
+            full[w] |= x;
+        }
+        return full;
+    }
+
+    // a model of F' as one of F, both as table indices (bit n - v set: v false).
+    // R is replayed backwards and every clause it finds falsified is satisfied
+    // through its witness, which no clause removed after it contradicts
+    word extend(word reduced) const {
+        word value(0);
+        for (std::size_t i(0); i < kept.size(); i++) {
+            value |= word(!((reduced >> (kept.size() - 1 - i)) & 1)) << (kept[i] - 1);
+        }
+        for (auto j(removed.size()); j-- > 0;) {
+            bool satisfied(false);
+            for (const auto &l : removed[j]) {
+                satisfied |= ((value >> ((l > 0 ? l : -l) - 1)) & 1) == (l > 0);
+            }
+            if (!satisfied) {
+                const auto v(witness[j] > 0 ? witness[j] : -witness[j]);
+                value = (value & ~(word(1) << (v - 1))) | word(witness[j] > 0) << (v - 1);
+            }
+        }
+        word r(0);
+        for (std::size_t v(1); v <= n; v++) {
+            r |= word(!((value >> (v - 1)) & 1)) << (n - v);
+        }
+        return r;
+    }
+
+    // a universe index of F' (one term per clause) as one of F: each clause
+    // bit moves to the clause it came from, resolvent bits drop
+    template<typename N>
+    limbs<0> universal(const N &index) const {
+        limbs<0> r(m + 1);
+        for (std::size_t i(0); i < origin.size(); i++) {
+            if (index.test(i) && origin[i] != none) {
+                r.set(origin[i]);
+            }
+        }
+        return r;
+    }
+
+    static word extract(word k, word select) {
+#ifdef __BMI2__
+        return _pext_u64(k, select);
+#else
+        word r(0);
+        for (word b(1); select; b <<= 1, select &= select - 1) {
+            r |= k & select & -select ? b : 0;
+        }
+        return r;
+#endif
+    }
+};
+
+struct preprocess_limits {
+    std::size_t occurrences = 16;    // bve: only variables with at most this many occurrences
+    std::size_t resolvent = 16;      // bve: longest resolvent accepted
+};
+
+inline std::pair<formula, reconstruction> preprocess(const formula &cnf, const preprocess_limits &limits = preprocess_limits()) {
+    reconstruction rec;
+    rec.n = cnf.n;
+    rec.m = cnf.size();
+    if (cnf.n > 64) {
+        throw std::runtime_error("preprocess: " + std::to_string(cnf.n) + " variables, at most 64 are supported");
+    }
+
+    std::vector<clause_bits> clauses;
+    std::vector<std::size_t> origin;
+    std::vector<char> alive;
+    for (std::size_t j(0); j < cnf.size(); j++) {
+        clause_bits c{0, 0};
+        for (const auto &l : cnf[j]) {
+            (l > 0 ? c.pos : c.neg) |= word(1) << ((l > 0 ? l : -l) - 1);
+        }
+        clauses.push_back(c);
+        origin.push_back(j);
+        alive.push_back(!(c.pos & c.neg));
+    }
+
+    auto remove = [&](std::size_t j, int witness) {
+        const auto &c(clauses[j]);
+        for (std::size_t v(1); v <= 64; v++) {
+            if ((c.pos >> (v - 1)) & 1) {
+                rec.removed.add(static_cast<int>(v));
+            } else if ((c.neg >> (v - 1)) & 1) {
+                rec.removed.add(-static_cast<int>(v));
+            }
+        }
+        rec.removed.close();
+        rec.witness.push_back(witness);
+        alive[j] = 0;
+    };
+    auto conflict = [&]() {
+        for (std::size_t j(0); j < clauses.size(); j++) {
+            if (alive[j] && !clauses[j].vars()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (bool changed(true); changed && !conflict();) {
+        changed = false;
+
+        // unit propagation: (l) goes to R, clauses with l are subsumed by it,
+        // clauses with -l lose that literal
+        for (std::size_t j(0); j < clauses.size(); j++) {
+            if (!alive[j] || clauses[j].size() != 1) {
+                continue;
+            }
+            const auto u(clauses[j]);
+            remove(j, u.pos ? __builtin_ctzll(u.pos) + 1 : -(__builtin_ctzll(u.neg) + 1));
+            rec.units++;
+            changed = true;
+            for (std::size_t i(0); i < clauses.size(); i++) {
+                if (!alive[i]) {
+                    continue;
+                }
+                if ((clauses[i].pos & u.pos) || (clauses[i].neg & u.neg)) {
+                    alive[i] = 0;
+                } else {
+                    clauses[i].pos &= ~u.neg;
+                    clauses[i].neg &= ~u.pos;
+                }
+            }
+        }
+        if (conflict()) {
+            break;
+        }
+
+        // pure literals: their clauses go to R
+        word pos(0), neg(0);
+        for (std::size_t j(0); j < clauses.size(); j++) {
+            if (alive[j]) {
+                pos |= clauses[j].pos;
+                neg |= clauses[j].neg;
+            }
+        }
+        if (const auto pure = (pos & ~neg) | (neg & ~pos)) {
+            rec.pure += __builtin_popcountll(pure);
+            changed = true;
+            for (std::size_t j(0); j < clauses.size(); j++) {
+                if (alive[j] && clauses[j].vars() & pure) {
+                    const auto l(__builtin_ctzll(clauses[j].vars() & pure));
+                    remove(j, (clauses[j].pos >> l) & 1 ? l + 1 : -(l + 1));
+                }
+            }
+        }
+
+        // duplicates and subsumption, shortest clauses first, each one checked
+        // against the occurrence list of its rarest literal
+        std::vector<std::size_t> order;
+        std::vector<std::vector<std::size_t>> occ(128);
+        for (std::size_t j(0); j < clauses.size(); j++) {
+            if (alive[j]) {
+                order.push_back(j);
+                for (auto w(clauses[j].pos); w; w &= w - 1) {
+                    occ[__builtin_ctzll(w)].push_back(j);
+                }
+                for (auto w(clauses[j].neg); w; w &= w - 1) {
+                    occ[64 + __builtin_ctzll(w)].push_back(j);
+                }
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return clauses[a].size() < clauses[b].size(); });
+        for (const auto &d : order) {
+            if (!alive[d]) {
+                continue;
+            }
+            std::size_t rarest(128);
+            for (std::size_t l(0); l < 128; l++) {
+                const auto &c(clauses[d]);
+                if (((l < 64 ? c.pos : c.neg) >> (l % 64)) & 1 && (rarest == 128 || occ[l].size() < occ[rarest].size())) {
+                    rarest = l;
+                }
+            }
+            if (rarest == 128) {
+                continue;
+            }
+            for (const auto &c : occ[rarest]) {
+                if (c != d && alive[c] && clauses[d].subsumes(clauses[c])) {
+                    alive[c] = 0;
+                    rec.subsumed++;
+                    changed = true;
+                }
+            }
+        }
+
+        // bounded variable elimination: replace the clauses on x by their
+        // non-tautological resolvents when that does not add clauses
+        for (std::size_t x(0); x < 64 && !changed; x++) {
+            const auto bit(word(1) << x);
+            std::vector<std::size_t> p, q;
+            for (std::size_t j(0); j < clauses.size(); j++) {
+                if (alive[j]) {
+                    if (clauses[j].pos & bit) {
+                        p.push_back(j);
+                    } else if (clauses[j].neg & bit) {
+                        q.push_back(j);
+                    }
+                }
+            }
+            if (p.empty() || q.empty() || p.size() + q.size() > limits.occurrences) {
+                continue;
+            }
+            std::vector<clause_bits> resolvents;
+            bool bounded(true);
+            for (const auto &a : p) {
+                for (const auto &b : q) {
+                    const clause_bits r{(clauses[a].pos | clauses[b].pos) & ~bit, (clauses[a].neg | clauses[b].neg) & ~bit};
+                    if (r.pos & r.neg) {
+                        continue;
+                    }
+                    if (r.size() > limits.resolvent || resolvents.size() == p.size() + q.size()) {
+                        bounded = false;
+                        break;
+                    }
+                    resolvents.push_back(r);
+                }
+                if (!bounded) {
+                    break;
+                }
+            }
+            if (!bounded) {
+                continue;
+            }
+            for (const auto &j : p) {
+                remove(j, static_cast<int>(x + 1));
+            }
+            for (const auto &j : q) {
+                remove(j, -static_cast<int>(x + 1));
+            }
+            for (const auto &r : resolvents) {
+                clauses.push_back(r);
+                origin.push_back(reconstruction::none);
+                alive.push_back(1);
+            }
+            rec.eliminated++;
+            changed = true;
+        }
+    }
+
+    // F': the surviving clauses over the surviving variables, renumbered in order
+    formula reduced;
+    word used(0);
+    const bool unsat(conflict());
+    for (std::size_t j(0); j < clauses.size(); j++) {
+        if (alive[j] && !unsat) {
+            used |= clauses[j].vars();
+        }
+    }
+    std::vector<int> rename(65, 0);
+    for (std::size_t v(1); v <= 64; v++) {
+        if ((used >> (v - 1)) & 1) {
+            rec.kept.push_back(v);
+            rename[v] = static_cast<int>(rec.kept.size());
+        }
+    }
+    for (std::size_t j(0); j < clauses.size(); j++) {
+        if (!alive[j] || (unsat && clauses[j].vars())) {
+            continue;
+        }
+        for (std::size_t v(1); v <= 64; v++) {
+            if ((clauses[j].pos >> (v - 1)) & 1) {
+                reduced.add(rename[v]);
+            } else if ((clauses[j].neg >> (v - 1)) & 1) {
+                reduced.add(-rename[v]);
+            }
+        }
+        reduced.close();
+        rec.origin.push_back(origin[j]);
+        if (unsat) {
+            break;
+        }
+    }
+    reduced.n = rec.kept.size();
+    return std::make_pair(reduced, rec);
+}
+
+#endif
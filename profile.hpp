@@ -0,0 +1,217 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_PROFILE_HPP
+#define UNT_PROFILE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <sys/resource.h>
+
+// phase timers and hot-path counters. built with -DUNT_NO_PROFILE every hook
+// below is an empty inline function and the counters do not exist. limb ops
+// are the multi-word adds, subtractions, shifts and compares of limbs.hpp.
+//
+// counters are per thread, one block each out of a fixed array, so a hot path
+// pays a relaxed load and store on a line no other thread writes. an instance
+// profile is the difference of two snapshots: of every block when instances
+// run one after another, of its own thread's block in a batch (an instance and
+// its probes stay on one worker there). phases are timed on the thread that
+// opened the profile.
+
+enum COUNTER {
+    PHI_CALLS,
+    LIMB_OPS,
+    ALLOCATED,
+    COUNTERS
+};
+
+// SIMPLIFY: preprocess; ENCODE: the falsification table (sat_equation);
+// DECODE: the sat and universal spaces, printed; SEARCH: the phi probes or the
+// horowitz-sahni merge; CHECKPOINT: writing --checkpoint files (also counted
+// in the ENCODE or SEARCH it interrupts)
+enum PHASE {
+    SIMPLIFY,
+    ENCODE,
+    DECODE,
+    SEARCH,
+    CHECKPOINT,
+    PHASES
+};
+
+inline const char *phase_name(PHASE phase) {
+    switch (phase) {
+        case SIMPLIFY:
+            return "simplify";
+        case ENCODE:
+            return "encode";
+        case DECODE:
+            return "decode";
+        case SEARCH:
+            return "search";
+        default:
+            return "checkpoint";
+    }
+}
+
+inline const char *counter_name(COUNTER counter) {
+    switch (counter) {
+        case PHI_CALLS:
+            return "phi_calls";
+        case LIMB_OPS:
+            return "limb_ops";
+        default:
+            return "allocated_bytes";
+    }
+}
+
+struct profile_record {
+    std::string instance;
+    std::size_t n = 0, m = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds phase[PHASES]{};
+    std::uint64_t counter[COUNTERS]{};
+    long peak_rss = 0;
+};
+
+#ifndef UNT_NO_PROFILE
+
+struct alignas(64) counter_block {
+    std::atomic<std::uint64_t> c[COUNTERS];
+};
+
+// threads past the last block share it, and may drop counts
+constexpr std::size_t counter_blocks = 1024;
+
+inline counter_block *counter_table() {
+    static counter_block blocks[counter_blocks];
+    return blocks;
+}
+
+inline std::atomic<std::size_t> &counter_threads() {
+    static std::atomic<std::size_t> threads{0};
+    return threads;
+}
+
+inline counter_block &own_counters() {
+    static thread_local counter_block *mine = counter_table() + std::min(counter_threads()++, counter_blocks - 1);
+    return *mine;
+}
+
+inline void profile_count(COUNTER c, std::uint64_t k = 1) {
+    auto &x(own_counters().c[c]);
+    x.store(x.load(std::memory_order_relaxed) + k, std::memory_order_relaxed);
+}
+
+// the counters of this thread, or of every thread
+inline void snapshot(std::uint64_t (&out)[COUNTERS], bool all) {
+    for (std::size_t k(0); k < COUNTERS; k++) {
+        out[k] = 0;
+    }
+    const auto first(all ? counter_table() : &own_counters());
+    const auto last(all ? counter_table() + std::min(counter_threads().load(), counter_blocks) : first + 1);
+    for (auto b(first); b != last; b++) {
+        for (std::size_t k(0); k < COUNTERS; k++) {
+            out[k] += b->c[k].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// the profile phases of this thread are charged to
+inline profile_record *&current_profile() {
+    static thread_local profile_record *current = nullptr;
+    return current;
+}
+
+// opens record r on this thread; finish() fills in the totals
+class instance_profile {
+public:
+    instance_profile(profile_record &r, bool all) : r(r), all(all), start(std::chrono::steady_clock::now()) {
+        snapshot(base, all);
+        current_profile() = &r;
+    }
+
+    instance_profile(const instance_profile &) = delete;
+
+    instance_profile &operator=(const instance_profile &) = delete;
+
+    ~instance_profile() { current_profile() = nullptr; }
+
+    void finish() {
+        r.total = std::chrono::steady_clock::now() - start;
+        snapshot(r.counter, all);
+        for (std::size_t k(0); k < COUNTERS; k++) {
+            r.counter[k] -= base[k];
+        }
+        struct rusage u{};
+        ::getrusage(RUSAGE_SELF, &u);
+        r.peak_rss = u.ru_maxrss;
+    }
+
+private:
+    profile_record &r;
+    bool all;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t base[COUNTERS];
+};
+
+// charges its lifetime to phase p of the open profile, if any
+class phase_timer {
+public:
+    explicit phase_timer(PHASE p) : r(current_profile()), p(p) {
+        if (r) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    phase_timer(const phase_timer &) = delete;
+
+    phase_timer &operator=(const phase_timer &) = delete;
+
+    ~phase_timer() { stop(); }
+
+    // charges the time so far and disarms
+    void stop() {
+        if (r) {
+            r->phase[p] += std::chrono::steady_clock::now() - start;
+            r = nullptr;
+        }
+    }
+
+private:
+    profile_record *r;
+    PHASE p;
+    std::chrono::steady_clock::time_point start;
+};
+
+#else
+
+inline void profile_count(COUNTER, std::uint64_t = 1) {}
+
+class instance_profile {
+public:
+    instance_profile(profile_record &, bool) {}
+
+    void finish() {}
+};
+
+class phase_timer {
+public:
+    explicit phase_timer(PHASE) {}
+
+    void stop() {}
+};
+
+#endif
+
+#endif
@@ -14,110 +14,1080 @@
 // http://jango.com/music/Oscar+Riveros
 // https://www.reverbnation.com/maxtuno
 
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <new>
+#include <string>
+#include <tuple>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "batch.hpp"
+#include "cache.hpp"
+#include "checkpoint.hpp"
+#include "cube_and_conquer.hpp"
+#include "deadline.hpp"
+#include "dimacs.hpp"
+#include "horowitz_sahni.hpp"
+#include "incremental.hpp"
+#include "limbs.hpp"
+#include "models.hpp"
+#include "out_of_core.hpp"
+#include "phi.hpp"
+#include "pool.hpp"
+#include "preprocess.hpp"
+#include "profile.hpp"
+#include "server.hpp"
+#include "shard.hpp"
+#include "table.hpp"
+#include "writer.hpp"
+
 using I = __int128;
 
-enum ORDER {
-    DIRECT,
-    INVERSE
+// ABS: abstract_binary_search, HS: the exact horowitz_sahni merge,
+// EXHAUSTIVE: phi at every index of the universe
+enum ENGINE {
+    ABS,
+    HS,
+    EXHAUSTIVE
 };
 
-auto sat_space = [](I n, const I &size) {
-    std::vector<bool> bits(I(1) << size, false);
-    for (I i(0); i < bits.size(); i++) {
-        bits[i] = static_cast<bool>(n % 2 == 0);
-        n /= 2;
-    }
-    return bits;
+// what report prints of the sat space: the bits, the models, or their count
+enum LISTING {
+    SPACE,
+    MODELS,
+    COUNT
 };
 
-auto phi = [](I n, const auto &universe) {
-    auto[i, s] = std::make_pair(I(0), I(0));
-    for (I i(0); i < universe.size(); i++) {
-        if (n % 2) {
-            s += universe[i];
-        }
-        n /= 2;
+struct options {
+    ENGINE engine = ENGINE::ABS;
+    std::size_t matches = 1;
+    PHI phi = PHI::AUTO;
+    std::size_t phi_memory = 0;
+    std::size_t probes = 1;
+    std::size_t threads = 0;
+    bool batch = false;
+    std::size_t cubes = 0;
+    bool first_sat = false;
+    bool preprocess = false;
+    LISTING listing = LISTING::SPACE;
+    std::size_t models = 0;
+    std::string out_of_core;
+    std::size_t resident = std::size_t(256) << 20;
+    FORMAT format = FORMAT::TEXT;
+    BITS bits = BITS::BIN;
+    bool profile = false;
+    FORMAT profile_format = FORMAT::JSON;
+    std::string edits;
+    std::size_t cache = 0;
+    std::string cache_file;
+    std::string checkpoint;
+    std::chrono::nanoseconds checkpoint_every = std::chrono::seconds(60);
+    bool resume = false;
+    std::string serve;
+    std::size_t queue = 64;
+    std::size_t shards = 0;
+};
+
+options config;
+
+#ifndef UNT_NO_PROFILE
+// every allocation is charged to the ALLOCATED counter of its thread. all the
+// replaceable forms are here (plain, array, aligned, nothrow, sized delete),
+// so none goes around the count and each delete frees what its new took
+void *counted_alloc(std::size_t size, std::size_t align) {
+    profile_count(ALLOCATED, size);
+    size = size ? size : 1;
+    if (align <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    void *p(nullptr);
+    return ::posix_memalign(&p, align, size) ? nullptr : p;
+}
+
+// out of line: inlined into a delete expression, free() would pass for the
+// wrong partner of the new that allocated the pointer (-Wmismatched-new-delete)
+__attribute__((noinline)) void counted_free(void *p) noexcept { std::free(p); }
+
+void *operator new(std::size_t size) {
+    if (auto p = counted_alloc(size, 0)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return ::operator new(size); }
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    if (auto p = counted_alloc(size, static_cast<std::size_t>(align))) {
+        return p;
     }
-    return s;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size, 0); }
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size, 0); }
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(align));
+}
+
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *p) noexcept { counted_free(p); }
+
+void operator delete[](void *p) noexcept { counted_free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { counted_free(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { counted_free(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { counted_free(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept { counted_free(p); }
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept { counted_free(p); }
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept { counted_free(p); }
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { counted_free(p); }
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { counted_free(p); }
+#endif
+
+thread_pool &workers() {
+    static thread_pool pool(config.threads ? config.threads : std::thread::hardware_concurrency());
+    return pool;
+}
+
+// standard output, buffered until the end of the run
+writer &console() {
+    static writer out(&std::cout);
+    return out;
+}
+
+// --cache, --cache-file
+result_cache &results() {
+    static result_cache cache(config.cache, config.cache_file);
+    return cache;
+}
+
+// what a batch worker reuses from one instance to the next: its text buffer
+// and a pool of its own (inline, the batch already fills the cores) for the
+// k-ary probes
+struct batch_scratch {
+    writer out;
+    thread_pool lanes{1};
+
+    std::string take() { return out.take(); }
 };
 
-std::pair<I, I> abstract_binary_search(const std::vector<I> &universe, I t) {
-    auto[complexity, i, j] = std::make_tuple(I(0), I(0), (I(1) << universe.size()) - 1);
+// [i, j) starts as every index of the universe, the one of all its terms included
+template<typename N>
+search_state<N> search_start(const std::size_t &size) {
+    const auto width(size + 1);
+    return search_state<N>{N(width), N::pow2(size, width), 0, 0};
+}
+
+// the search from `at`, which it carries along: tick(at) after every round is
+// where a checkpoint may save it. every round polls the thread's deadline
+template<typename N, typename U, typename T, typename P, typename F>
+std::pair<N, I> abstract_binary_search(const scratch_vector<U> &universe, const T &t, P &probe, search_state<N> &at, F &&tick) {
+    const auto width(universe.size() + 1);
+    auto &i(at.i), &j(at.j);
+    auto[n, s] = std::make_pair(N(width), T(t));
     while (i < j) {
-        I n = (i + j) / 2;
-        I s = phi(n, universe);
+        deadline::poll();
+        n = i;
+        n += j;
+        n.halve();
+        probe(n, s);
+        at.probes++;
         if (s < t) {
-            i = n + 1;
+            i = n;
+            i.increment();
         } else if (s > t) {
             j = n;
         } else {
-            return std::make_pair(n, complexity);;
+            return std::make_pair(n, at.rounds);
+        }
+        at.rounds++;
+        tick(at);
+    }
+    return std::make_pair(N(width), at.rounds);
+}
+
+template<typename N, typename U, typename T, typename P>
+std::pair<N, I> abstract_binary_search(const scratch_vector<U> &universe, const T &t, P &probe) {
+    auto at(search_start<N>(universe.size()));
+    return abstract_binary_search(universe, t, probe, at, [](const search_state<N> &) {});
+}
+
+template<typename N, typename U, typename T>
+std::pair<N, I> abstract_binary_search(const scratch_vector<U> &universe, const T &t) {
+    phi_engine<N, U, T> probe(universe, T(t));
+    return abstract_binary_search<N>(universe, t, probe);
+}
+
+// abstract_binary_search when only the comparison is at hand: compare(n) is the
+// sign of phi(n, universe) - t, for a universe of size terms
+template<typename N, typename C>
+std::pair<N, I> abstract_binary_search_by(const std::size_t &size, C &&compare) {
+    const auto width(size + 1);
+    auto[complexity, i, j] = std::make_tuple(I(0), N(width), N::pow2(size, width));
+    N n(width);
+    while (i < j) {
+        deadline::poll();
+        n = i;
+        n += j;
+        n.halve();
+        const auto c(compare(n));
+        if (c < 0) {
+            i = n;
+            i.increment();
+        } else if (c > 0) {
+            j = n;
+        } else {
+            return std::make_pair(n, complexity);
         }
         complexity++;
     }
-    return std::make_pair(I(0), complexity);
+    return std::make_pair(N(width), complexity);
 }
 
-std::pair<I, std::vector<I>> sat_equation(const std::vector<std::vector<I>> &cnf, const I &m, const I &n) {
-    auto[sat, universe] = std::make_pair(I(0), std::vector<I>(m, I(0)));
-    for (I j(0); j < m; j++) {
-        I e(0);
-        for (I i(0); i < n; i++) {
-            e += cnf[j][n - 1 - i] > I(0) ? I(1) << i : I(0);
+// the rounds of a search with `lanes` probes each, from `at`: [i, j) shrinks to
+// about 1 / (lanes + 1) of its size every round. compare(points, count, signs)
+// sets signs[k] to the sign of phi(points[k]) - t for every k < count
+template<typename N, typename C, typename F>
+N kary_rounds(const std::size_t &size, std::size_t lanes, search_state<N> &at, C &&compare, F &&tick) {
+    const auto width(size + 1);
+    auto &i(at.i), &j(at.j);
+    scratch_vector<N> points(lanes, N(width));
+    scratch_vector<int> signs(lanes);
+    while (i < j) {
+        deadline::poll();
+        N q(j);
+        q -= i;
+        const auto r(q.div_word(lanes + 1));
+        std::size_t count(0);
+        for (std::size_t k(1); k <= lanes; k++) {
+            N p(q);
+            p.mul_word(k);
+            p += i;
+            p += r * k / (lanes + 1);
+            if (!count || points[count - 1] != p) {
+                points[count++] = p;
+            }
         }
-        universe.emplace_back((I(1) << e));
-        sat += universe.back();
+        compare(points, count, signs);
+        at.probes += count;
+        std::size_t k(0);
+        while (k < count && signs[k] < 0) {
+            k++;
+        }
+        if (k < count && !signs[k]) {
+            return points[k];
+        }
+        if (k < count) {
+            j = points[k];
+        }
+        if (k > 0) {
+            i = points[k - 1];
+            i.increment();
+        }
+        at.rounds++;
+        tick(at);
+    }
+    return N(width);
+}
+
+// abstract_binary_search with `lanes` probes per round evaluated on the pool.
+// returns the index, the rounds (the serial complexity counter) and the probes
+// evaluated. phi is not monotone, so the other cut points can steer it away
+// from the index the serial search finds: it may end on another match, or on
+// none where the serial search has one
+template<typename N, typename U, typename T, typename E, typename F>
+std::tuple<N, I, I> kary_search(const scratch_vector<U> &universe, const T &t, E &probe, std::size_t lanes, thread_pool &pool, search_state<N> &at, F &&tick) {
+    scratch_vector<E> engines(lanes, probe);
+    scratch_vector<T> sums(lanes, T(t));
+    const auto n(kary_rounds(universe.size(), lanes, at, [&](const scratch_vector<N> &points, std::size_t count, scratch_vector<int> &signs) {
+        pool.run(count, [&](std::size_t k) {
+            engines[k](points[k], sums[k]);
+            signs[k] = compare(sums[k], t);
+        });
+    }, tick));
+    for (const auto &e : engines) {
+        probe.calls += e.calls;
+        probe.elapsed += e.elapsed;
+    }
+    return std::make_tuple(n, at.rounds, at.probes);
+}
+
+template<typename N, typename U, typename T, typename E>
+std::tuple<N, I, I> kary_search(const scratch_vector<U> &universe, const T &t, E &probe, std::size_t lanes, thread_pool &pool) {
+    auto at(search_start<N>(universe.size()));
+    return kary_search(universe, t, probe, lanes, pool, at, [](const search_state<N> &) {});
+}
+
+// kary_search with one probe per round on each of the --shards workers, which
+// compare phi against t themselves and answer the sign: a probe point goes
+// out, 3 words come back. per[k] counts the probes of worker k; their phi
+// counters are added to probe's. it cuts [i, j) as --probes=N does, so past
+// one worker it may end on another index than the serial search, or on none
+template<typename N, typename U, typename T, typename E, typename F>
+std::tuple<N, I, I> shard_search(const scratch_vector<U> &universe, const T &t, E &probe, std::vector<std::size_t> &per, search_state<N> &at, F &&tick) {
+    const auto width(universe.size() + 1);
+    shard_pool shards(per.size(), [&](const std::vector<word> &request, std::vector<word> &reply) {
+        N n(width);
+        T s(t);
+        std::copy(request.begin(), request.end(), n.data());
+        const auto calls(probe.calls);
+        const auto elapsed(probe.elapsed);
+        probe(n, s);
+        reply = {word(compare(s, t) + 1), probe.calls - calls, word((probe.elapsed - elapsed).count())};
+    });
+    std::vector<word> point;
+    const auto n(kary_rounds(universe.size(), shards.size(), at, [&](const scratch_vector<N> &points, std::size_t count, scratch_vector<int> &signs) {
+        for (std::size_t k(0); k < count; k++) {
+            point.assign(points[k].data(), points[k].data() + points[k].size());
+            shards.send(k, point);
+        }
+        for (std::size_t k(0); k < count; k++) {
+            const auto r(shards.receive(k));
+            signs[k] = static_cast<int>(r[0]) - 1;
+            probe.calls += r[1];
+            probe.elapsed += std::chrono::nanoseconds(r[2]);
+            profile_count(PHI_CALLS, r[1]);
+            per[k]++;
+        }
+    }, tick));
+    return std::make_tuple(n, at.rounds, at.probes);
+}
+
+// what a scan of indices found: how many match and the least of them
+struct scan_result {
+    word matches = 0, first = ~word(0);
+};
+
+// phi at every index of [lo, hi) against t, the deadline polled every 2^12
+template<typename N, typename T, typename E>
+scan_result scan_range(const std::size_t &width, const T &t, E &probe, word lo, word hi) {
+    scan_result r;
+    N n(width);
+    T s(t);
+    n[0] = lo;
+    for (auto x(lo); x < hi; x++, n.increment()) {
+        if (!(x & 4095)) {
+            deadline::poll();
+        }
+        probe(n, s);
+        if (s == t) {
+            r.matches++;
+            r.first = std::min(r.first, x);
+        }
+    }
+    return r;
+}
+
+// scan_range over [0, 2^m) on the --shards workers: 1 / 64 of a worker's share
+// at a time to whichever worker is free, so one that finishes early takes more.
+// per[k] counts the ranges of worker k; their phi counters are added to probe's
+template<typename N, typename U, typename T, typename E>
+scan_result shard_scan(const scratch_vector<U> &universe, const T &t, E &probe, std::vector<std::size_t> &per) {
+    const auto width(universe.size() + 1);
+    const auto total(word(1) << universe.size());
+    const auto chunk(std::max<word>(total / (64 * per.size()), 1));
+    shard_pool shards(per.size(), [&](const std::vector<word> &request, std::vector<word> &reply) {
+        const auto calls(probe.calls);
+        const auto elapsed(probe.elapsed);
+        const auto r(scan_range<N>(width, t, probe, request[0], request[1]));
+        reply = {r.matches, r.first, probe.calls - calls, word((probe.elapsed - elapsed).count())};
+    });
+    scan_result all;
+    std::vector<char> busy(shards.size(), 0);
+    std::size_t out(0);
+    word next(0);
+    auto hand = [&](std::size_t k) {
+        if (next < total) {
+            const auto hi(std::min(total, next + chunk));
+            shards.send(k, {next, hi});
+            next = hi;
+            busy[k] = 1;
+            per[k]++;
+            out++;
+        }
+    };
+    for (std::size_t k(0); k < shards.size(); k++) {
+        hand(k);
+    }
+    while (out) {
+        deadline::poll();
+        const auto k(shards.ready(busy));
+        const auto r(shards.receive(k));
+        busy[k] = 0;
+        out--;
+        all.matches += r[0];
+        all.first = std::min(all.first, r[1]);
+        probe.calls += r[2];
+        probe.elapsed += std::chrono::nanoseconds(r[3]);
+        profile_count(PHI_CALLS, r[2]);
+        hand(k);
+    }
+    return all;
+}
+
+// the table and the universe, one term per clause, both sum_width(n, m) bits
+// wide so phi never wraps; with split > 0 the table is built cube by cube over
+// the first `split` variables, with a checkpoint tile by tile from the last one
+// saved
+template<typename T>
+std::pair<T, scratch_vector<cube_words>> sat_equation(const formula &cnf, const std::size_t &m, const std::size_t &n, const std::size_t &split = 0,
+                                                      checkpoint *saver = nullptr) {
+    auto[sat, universe] = std::make_pair(T(sum_width(n, m)), scratch_vector<cube_words>());
+    universe.reserve(m);
+    for (std::size_t j(0); j < m; j++) {
+        universe.emplace_back(clause_term(cnf[j], n));
+    }
+    if (saver) {
+        saver->build(universe, sat);
+    } else if (split) {
+        conquer_table(cnf, n, split, sat);
+    } else {
+        falsification_table(universe, n, sat);
     }
     return std::make_pair(sat, universe);
 }
 
-auto i128tos = [](I n) {
-    char *s = (char *) calloc(sizeof(char), std::numeric_limits<I>::max_digits10 + 1);
-    do {
-        *--s = "0123456789"[(n % 10)];
-        n /= 10;
-    } while (n);
-    return std::string(s);
+// the first --models models of table, or UNSAT
+auto print_models = [](const auto &table, const std::size_t &n, record &out) {
+    bool none(true);
+    for (const auto &x : models(table, n, config.models)) {
+        out.model("SAT MODEL", "models", x, n);
+        none = false;
+    }
+    if (none) {
+        out.model("SAT MODEL", "models", ~word(0), n);
+    }
+};
+
+// SAT SPACE, or the models (--models, in increasing table index: from the right
+// end of SAT SPACE), then SAT COUNT
+auto print_listing = [](const auto &table, const std::size_t &n, record &out) {
+    if (config.listing == LISTING::SPACE) {
+        out.space("SAT SPACE", "sat_space", table, std::size_t(1) << n, ORDER::INVERSE);
+    }
+    if (config.listing == LISTING::MODELS) {
+        print_models(table, n, out);
+    }
+    out.field("SAT COUNT", "sat_count", model_count(table, n));
+};
+
+auto print_preprocess = [](const reconstruction *rec, const std::size_t &n, const std::size_t &m, record &out) {
+    if (!rec) {
+        return;
+    }
+    auto &o(out.key("PREPROCESS", "preprocess"));
+    if (out.json()) {
+        o << "{\"n\":[" << rec->n << ',' << n << "],\"m\":[" << rec->m << ',' << m << "],\"units\":" << rec->units << ",\"pure\":" << rec->pure
+          << ",\"subsumed\":" << rec->subsumed << ",\"eliminated\":" << rec->eliminated << '}';
+    } else {
+        o << "n " << rec->n << " -> " << n << ", m " << rec->m << " -> " << m << " (" << rec->units << " units, " << rec->pure << " pure, "
+          << rec->subsumed << " subsumed, " << rec->eliminated << " eliminated)";
+    }
+};
+
+// 2^(n + m), the size of the universal space
+auto print_shape = [](const std::size_t &n, const std::size_t &m, record &out) {
+    if (out.json()) {
+        out.field("", "n", n);
+        out.field("", "m", m);
+    } else {
+        out.key("2^(n + m)", "") << "2^(" << n << " + " << m << ")";
+    }
 };
 
-auto print = [](const auto &bits, ORDER order) {
-    if (order == ORDER::DIRECT) {
-        for (auto bit = bits.begin(); bit != bits.end(); bit++) {
-            std::cout << *bit;
+// the phi engine the abs search runs on, sized for --probes lanes (or one lane
+// per --shards worker)
+template<typename N, typename U, typename T>
+phi_engine<N, U, T> abs_probe(const scratch_vector<U> &universe, const T &zero) {
+    const auto lanes(config.shards ? config.shards : config.probes);
+    const auto expected(lanes > 1 ? lanes * (universe.size() / std::log2(lanes + 1.0) + 1) : 0);
+    return phi_engine<N, U, T>(universe, zero, config.phi, expected, config.phi_memory);
+}
+
+// abstract_binary_search, or kary_search with --probes lanes on the pool: the
+// index, the rounds and the probes evaluated
+template<typename N, typename U, typename T, typename E>
+std::tuple<N, I, I> abs_search(const scratch_vector<U> &universe, const T &sat, E &probe, thread_pool &pool) {
+    if (config.probes > 1) {
+        return kary_search<N>(universe, sat, probe, config.probes, pool);
+    }
+    const auto r(abstract_binary_search<N>(universe, sat, probe));
+    return std::make_tuple(r.first, r.second, I(probe.calls));
+}
+
+// abs_search from `at`, tick(at) after every round
+template<typename N, typename U, typename T, typename E, typename F>
+std::tuple<N, I, I> abs_search(const scratch_vector<U> &universe, const T &sat, E &probe, thread_pool &pool, search_state<N> &at, F &&tick) {
+    if (config.probes > 1) {
+        return kary_search<N>(universe, sat, probe, config.probes, pool, at, tick);
+    }
+    const auto r(abstract_binary_search<N>(universe, sat, probe, at, tick));
+    return std::make_tuple(r.first, r.second, at.probes);
+}
+
+// --shards: the work each worker process did, in `unit`s
+auto print_shards = [](const std::vector<std::size_t> &per, const char *unit, record &out) {
+    if (per.empty()) {
+        return;
+    }
+    if (out.json()) {
+        for (const auto &k : per) {
+            out.item("", "shards", k);
         }
+        return;
+    }
+    auto &o(out.key("SHARDS", ""));
+    o << per.size() << " workers,";
+    for (const auto &k : per) {
+        o << ' ' << k;
+    }
+    o << ' ' << unit;
+};
+
+// how many snapshots this run wrote and their cost, and whether it resumed one
+auto print_checkpoints = [](const checkpoint &saver, record &out) {
+    if (out.json()) {
+        out.field("", "checkpoints", saver.written);
+        out.field("", "checkpoint_ns", saver.spent.count());
+        out.key("", "resumed") << (saver.resumed() ? "true" : "false");
+    } else {
+        out.key("CHECKPOINTS", "") << saver.written << " in " << saver.spent.count() << " ns" << (saver.resumed() ? ", resumed" : "");
+    }
+};
+
+template<typename E>
+std::string phi_mode(const E &probe) {
+    auto mode(std::string(phi_name(probe.mode)));
+    if (probe.mode == PHI::TABLES) {
+        mode += " (" + std::to_string(probe.chunks) + " x 2^" + std::to_string(probe.chunk_bits) + ")";
+    }
+    return mode;
+}
+
+// cnf is the formula solved; with rec it is the preprocessed form of another
+// one, and the spaces and the model are printed in the variables of that one
+auto report_on = [](const formula &cnf, const std::string &formula, record &out, thread_pool &pool, const reconstruction *rec) {
+    const auto n(cnf.n);
+    const auto m(cnf.size());
+    const auto original(rec ? rec->n : n);
+    if (config.engine == ENGINE::EXHAUSTIVE && m > 63) {
+        throw std::runtime_error(formula + ": " + std::to_string(m) + " clauses, the exhaustive engine takes at most 63");
     }
-    if (order == ORDER::INVERSE) {
-        for (auto bit = bits.rbegin(); bit != bits.rend(); bit++) {
-            std::cout << *bit;
+
+    with_limbs(sum_width(n, m), [&](auto zero) {
+        if (config.first_sat) {
+            auto sat(zero);
+            phase_timer encode(ENCODE);
+            auto x(conquer_table(cnf, n, config.cubes, sat, true));
+            if (rec && x != ~word(0)) {
+                x = rec->extend(x);
+            }
+            out.begin(formula);
+            print_preprocess(rec, n, m, out);
+            if (out.json()) {
+                out.field("", "cubes", std::min(config.cubes, n));
+            } else {
+                out.key("SAT CUBES", "") << "2^" << std::min(config.cubes, n);
+            }
+            out.model("SAT MODEL", "models", x, original);
+            out.end();
+            return;
+        }
+        // --checkpoint: the table tile by tile (no --cubes), then the abs search
+        std::unique_ptr<checkpoint> saver;
+        if (!config.checkpoint.empty()) {
+            saver.reset(new checkpoint(config.checkpoint, cache_hash(cache_key(cnf, config.probes)), n, config.checkpoint_every, config.resume));
         }
+        phase_timer encode(ENCODE);
+        auto[sat, universe] = sat_equation<decltype(zero)>(cnf, m, n, saver ? 0 : config.cubes, saver.get());
+        const auto full(rec ? rec->expand(sat) : limbs<0>());
+        encode.stop();
+        // a universal index and its space, in the original universe
+        auto universal_str = [&](const auto &u) { return rec ? rec->universal(u).str() : u.str(); };
+        auto universal_space = [&](const auto &u) {
+            phase_timer decode(DECODE);
+            if (rec) {
+                out.space("UNIVERSAL SAPCE", "universal_space", rec->universal(u), std::size_t(1) << original, ORDER::DIRECT);
+            } else {
+                out.space("UNIVERSAL SAPCE", "universal_space", u, std::size_t(1) << n, ORDER::DIRECT);
+            }
+        };
+        with_limbs(universe.size() + 1, [&](auto index) {
+            using N = decltype(index);
+            out.begin(formula);
+            print_preprocess(rec, n, m, out);
+            {
+                phase_timer decode(DECODE);
+                if (rec) {
+                    print_listing(full, original, out);
+                } else {
+                    print_listing(sat, n, out);
+                }
+            }
+
+            if (config.engine == ENGINE::HS) {
+                phase_timer search(SEARCH);
+                auto[matches, count, complexity] = horowitz_sahni<N>(universe, sat, config.matches);
+                search.stop();
+                for (const auto &universal : matches) {
+                    out.item("UNIVERSAL", "universals", universal_str(universal));
+                }
+                if (matches.empty()) {
+                    out.field("UNIVERSAL", "universal", universal_str(index));
+                }
+
+                universal_space(matches.empty() ? index : matches.front());
+
+                print_shape(n, m, out);
+                out.field("HS COMPLEXITY", "hs_complexity", complexity);
+                out.field("HS MATCHES", "hs_matches", count);
+            } else if (config.engine == ENGINE::EXHAUSTIVE) {
+                phase_timer search(SEARCH);
+                const auto total(word(1) << m);
+                phi_engine<N, cube_words, decltype(zero)> probe(universe, zero, config.phi, total, config.phi_memory);
+                std::vector<std::size_t> per(config.shards);
+                const auto r(config.shards ? shard_scan<N>(universe, sat, probe, per) : scan_range<N>(m + 1, sat, probe, 0, total));
+                search.stop();
+                auto universal(index);
+                universal[0] = r.matches ? r.first : 0;
+
+                out.field("UNIVERSAL", "universal", universal_str(universal));
+
+                universal_space(universal);
+
+                print_shape(n, m, out);
+                out.field("EX MATCHES", "ex_matches", r.matches);
+                out.field("EX PROBES", "ex_probes", total);
+                out.field("PHI MODE", "phi_mode", phi_mode(probe));
+                out.field("PHI CALLS", "phi_calls", probe.calls);
+                out.field("PHI TIME/PROBE", "phi_ns_per_probe", probe.calls ? probe.elapsed.count() / probe.calls : 0, " ns");
+                print_shards(per, "ranges", out);
+            } else {
+                phase_timer search(SEARCH);
+                auto probe(abs_probe<N>(universe, zero));
+                auto at(search_start<N>(universe.size()));
+                if (saver) {
+                    saver->restore(at);
+                }
+                auto tick = [&](const search_state<N> &s) {
+                    if (saver) {
+                        saver->tick(s, probe, sat);
+                    }
+                };
+                std::vector<std::size_t> per(config.shards);
+                auto[universal, rounds, probes] = config.shards ? shard_search<N>(universe, sat, probe, per, at, tick)
+                                                                : abs_search<N>(universe, sat, probe, pool, at, tick);
+                search.stop();
+                // with the runs a checkpoint resumes
+                const auto calls(probe.calls + (saver ? saver->phi_calls : 0));
+                const auto elapsed(probe.elapsed + (saver ? saver->phi_time : std::chrono::nanoseconds(0)));
+
+                out.field("UNIVERSAL", "universal", universal_str(universal));
+
+                universal_space(universal);
+
+                print_shape(n, m, out);
+                out.field("ABS COMPLEXITY", "abs_complexity", rounds);
+                out.field("ABS PROBES", "abs_probes", probes);
+                out.field("PHI MODE", "phi_mode", phi_mode(probe));
+                out.field("PHI CALLS", "phi_calls", calls);
+                out.field("PHI TIME/PROBE", "phi_ns_per_probe", calls ? elapsed.count() / calls : 0, " ns");
+                print_shards(per, "probes", out);
+            }
+            if (saver) {
+                print_checkpoints(*saver, out);
+                saver->finish();
+            }
+            out.end();
+        });
+    });
+};
+
+// --out-of-core: the table is a mapped file walked slice by slice, and the
+// search compares phi against it in a stream (abs engine, phi streamed)
+auto report_mapped = [](const formula &cnf, const std::string &formula, record &out) {
+    const auto n(cnf.n);
+    const auto m(cnf.size());
+    const auto k(slice_vars(n, config.resident));
+
+    phase_timer encode(ENCODE);
+    mapped_table sat(config.out_of_core, n);
+    build_mapped_table(cnf, n, k, sat);
+    encode.stop();
+    scratch_vector<cube_words> universe;
+    universe.reserve(m);
+    for (std::size_t j(0); j < m; j++) {
+        universe.emplace_back(clause_term(cnf[j], n));
     }
-    std::cout << std::endl;
+    with_limbs(universe.size() + 1, [&](auto index) {
+        using N = decltype(index);
+        out.begin(formula);
+        phase_timer decode(DECODE);
+        if (config.listing == LISTING::SPACE) {
+            out.space("SAT SPACE", "sat_space", [&](writer &o, BITS form) { print_mapped(sat, n, k, o, form); });
+        }
+        if (config.listing == LISTING::MODELS) {
+            bool none(true);
+            mapped_models(sat, n, k, config.models, [&](word x) {
+                out.model("SAT MODEL", "models", x, n);
+                none = false;
+            });
+            if (none) {
+                out.model("SAT MODEL", "models", ~word(0), n);
+            }
+        }
+        out.field("SAT COUNT", "sat_count", mapped_count(sat, n, k));
+        decode.stop();
+
+        phase_timer search(SEARCH);
+        std::vector<word> scratch;
+        std::size_t calls(0);
+        const auto start(std::chrono::steady_clock::now());
+        auto[universal, complexity] = abstract_binary_search_by<N>(universe.size(), [&](const N &x) {
+            calls++;
+            profile_count(PHI_CALLS);
+            return mapped_compare(x, universe, sat, k, scratch);
+        });
+        const std::chrono::nanoseconds elapsed(std::chrono::steady_clock::now() - start);
+        search.stop();
+
+        out.field("UNIVERSAL", "universal", universal.str());
+
+        {
+            phase_timer decode_universal(DECODE);
+            out.space("UNIVERSAL SAPCE", "universal_space", universal, std::size_t(1) << n, ORDER::DIRECT);
+        }
+
+        print_shape(n, m, out);
+        out.field("ABS COMPLEXITY", "abs_complexity", complexity);
+        out.field("ABS PROBES", "abs_probes", calls);
+        out.field("PHI MODE", "phi_mode", "streamed (2^" + std::to_string(k) + " slices)");
+        out.field("PHI CALLS", "phi_calls", calls);
+        out.field("PHI TIME/PROBE", "phi_ns_per_probe", calls ? elapsed.count() / calls : 0, " ns");
+        out.end();
+    });
 };
 
-auto report = [](const auto &cnf, const std::string &formula) {
-    const auto n(cnf.back().size());
+// --cache (abs engine): the table does not depend on the clause order, so it
+// is kept under the canonical form of cnf; the universe and the search do, so
+// the universal index and the search counters are kept under the clauses in
+// their order, each canonical. a repeat in another clause order takes the
+// table and searches again, one in another literal order only prints
+auto report_cached = [](const formula &cnf, const std::string &formula, record &out, thread_pool &pool) {
+    phase_timer encode(ENCODE);
+    const auto n(cnf.n);
     const auto m(cnf.size());
+    const auto table_key(cache_key(canonical(cnf), 0));
+    const auto search_key(cache_key(canonical_clauses(cnf), config.probes));
+    auto table(results().find(cache_hash(table_key), table_key));
+    auto found(results().find(cache_hash(search_key), search_key));
+    const char *state(table && found ? "hit" : table ? "table" : "miss");
+    std::string mode("cached");
+    std::size_t calls(0);
+    std::chrono::nanoseconds elapsed(0);
+    if (!table || !found) {
+        with_limbs(sum_width(n, m), [&](auto zero) {
+            using T = decltype(zero);
+            auto sat(zero);
+            scratch_vector<cube_words> universe;
+            if (table) {
+                std::copy(table->sat.begin(), table->sat.end(), sat.data());
+                universe.reserve(m);
+                for (std::size_t j(0); j < m; j++) {
+                    universe.emplace_back(clause_term(cnf[j], n));
+                }
+            } else {
+                std::tie(sat, universe) = sat_equation<T>(cnf, m, n, config.cubes);
+                cached_solve r;
+                r.key = table_key;
+                r.sat.assign(sat.data(), sat.data() + table_words(n));
+                table = results().insert(cache_hash(table_key), std::move(r));
+            }
+            encode.stop();
+            if (found) {
+                return;
+            }
+            with_limbs(universe.size() + 1, [&](auto index) {
+                using N = decltype(index);
+                phase_timer search(SEARCH);
+                auto probe(abs_probe<N>(universe, zero));
+                const auto result(abs_search<N>(universe, sat, probe, pool));
+                const auto &universal(std::get<0>(result));
+                cached_solve r;
+                r.key = search_key;
+                r.universal.assign(universal.data(), universal.data() + universal.size());
+                r.complexity = std::get<1>(result);
+                r.probes = std::get<2>(result);
+                found = results().insert(cache_hash(search_key), std::move(r));
+                mode = phi_mode(probe);
+                calls = probe.calls;
+                elapsed = probe.elapsed;
+            });
+        });
+    }
+    encode.stop();
 
-    auto[sat, universe] = sat_equation(cnf, m, n);
-    auto bits = sat_space(sat, n);
-    auto[universal, complexity] = abstract_binary_search(universe, sat);
+    phase_timer decode(DECODE);
+    limbs<0> universal(64 * found->universal.size());
+    std::copy(found->universal.begin(), found->universal.end(), universal.data());
+    out.begin(formula);
+    print_listing(table->sat, n, out);
+    out.field("UNIVERSAL", "universal", universal.str());
+    out.space("UNIVERSAL SAPCE", "universal_space", universal, std::size_t(1) << n, ORDER::DIRECT);
+    print_shape(n, m, out);
+    out.field("ABS COMPLEXITY", "abs_complexity", found->complexity);
+    out.field("ABS PROBES", "abs_probes", found->probes);
+    out.field("PHI MODE", "phi_mode", mode);
+    out.field("PHI CALLS", "phi_calls", calls);
+    out.field("PHI TIME/PROBE", "phi_ns_per_probe", calls ? elapsed.count() / calls : 0, " ns");
+    out.field("CACHE", "cache", state);
+    out.end();
+};
+
+auto report_any = [](const formula &cnf, const std::string &formula, writer &to, thread_pool &pool) {
+    record out(to, config.format, config.bits);
+    if (config.cache && config.engine == ENGINE::ABS && config.out_of_core.empty() && !config.first_sat && !config.preprocess) {
+        report_cached(cnf, formula, out, pool);
+        return;
+    }
+    if (!config.out_of_core.empty()) {
+        report_mapped(cnf, formula, out);
+        return;
+    }
+    if (!config.preprocess) {
+        report_on(cnf, formula, out, pool, nullptr);
+        return;
+    }
+    phase_timer simplify(SIMPLIFY);
+    const auto reduced(preprocess(cnf));
+    simplify.stop();
+    report_on(reduced.first, formula, out, pool, &reduced.second);
+};
+
+// a --serve subset-sum job: the values are the universe and t the target, so a
+// universal index found is a subset of the values that sums to t
+auto report_subset_sum = [](const scratch_vector<word> &values, word t, const std::string &name, writer &to, thread_pool &pool) {
+    record out(to, config.format, config.bits);
+    // sums of 64-bit values, which one word would wrap
+    limbs<2> target;
+    target[0] = t;
+    with_limbs(values.size() + 1, [&](auto index) {
+        using N = decltype(index);
+        phase_timer search(SEARCH);
+        auto probe(abs_probe<N>(values, limbs<2>()));
+        auto[universal, rounds, probes] = abs_search<N>(values, target, probe, pool);
+        search.stop();
 
-    std::cout << "EXAMPLE " << formula << std::endl;
-    std::cout << std::string(185, '=') << std::endl;
-    std::cout << "SAT SPACE       : ";
-    print(bits, ORDER::INVERSE);
+        out.begin(name);
+        out.field("TARGET", "target", t);
+        out.field("UNIVERSAL", "universal", universal.str());
+        bool none(true);
+        for (std::size_t i(0); i < values.size(); i++) {
+            if (universal.test(i)) {
+                out.item("SUBSET", "subset", values[i]);
+                none = false;
+            }
+        }
+        if (none) {
+            out.key("SUBSET", "subset") << (out.json() ? "[]" : "none");
+        }
+        if (out.json()) {
+            out.field("", "m", values.size());
+        } else {
+            out.key("2^m", "") << "2^" << values.size();
+        }
+        out.field("ABS COMPLEXITY", "abs_complexity", rounds);
+        out.field("ABS PROBES", "abs_probes", probes);
+        out.field("PHI MODE", "phi_mode", phi_mode(probe));
+        out.field("PHI CALLS", "phi_calls", probe.calls);
+        out.field("PHI TIME/PROBE", "phi_ns_per_probe", probe.calls ? probe.elapsed.count() / probe.calls : 0, " ns");
+        out.end();
+    });
+};
 
-    std::cout << "UNIVERSAL       : " << i128tos(universal) << std::endl;
+// --edits: the formula is solved, then solved again after every line of the
+// script: "a <literals> 0" adds a clause, "d <id>" removes one (the clauses of
+// the formula are 0 .. m - 1, an add prints the id it got). each solve first
+// tries the index carried over from the last one, and searches only if it no
+// longer matches
+auto report_edits = [](const formula &cnf, const std::string &formula, const std::string &script, writer &to) {
+    record out(to, config.format, config.bits);
+    const auto n(cnf.n);
+    const mapped_file file(script);
+    // edits add clauses without bound: a carry word of 64 bits covers any count.
+    // zero and the solver outlive the solves, so they are kept on the heap and
+    // each solve has the arena to itself
+    arena::heap_scope heap;
+    with_limbs(sum_width(n, ~std::size_t(0)), [&](auto zero) {
+        using T = decltype(zero);
+        incremental_sat<T> solver(cnf, zero);
+        auto solve = [&](const std::string &edit, std::chrono::nanoseconds edit_time) {
+            arena::heap_scope scratch(false);
+            const auto start(std::chrono::steady_clock::now());
+            with_limbs(solver.universe().size() + 1, [&](auto index) {
+                using N = decltype(index);
+                auto universal(index);
+                I complexity(0);
+                const bool warm(solver.warm(universal));
+                if (!warm) {
+                    phi_engine<N, cube_words, T> probe(solver.universe(), zero, config.phi);
+                    std::tie(universal, complexity) = abstract_binary_search<N>(solver.universe(), solver.table(), probe);
+                    T s(zero);
+                    phi(universal, solver.universe(), s);
+                    if (s == solver.table()) {
+                        solver.remember(universal, s);
+                    } else {
+                        solver.forget();
+                    }
+                }
+                const std::chrono::nanoseconds solve_time(std::chrono::steady_clock::now() - start);
+                out.begin(formula);
+                out.field("EDIT", "edit", edit);
+                print_listing(solver.table(), n, out);
+                out.field("UNIVERSAL", "universal", universal.str());
+                out.field("ABS COMPLEXITY", "abs_complexity", complexity);
+                out.field("WARM START", "warm", warm ? "yes" : "no");
+                out.field("EDIT TIME", "edit_ns", edit_time.count(), " ns");
+                out.field("SOLVE TIME", "solve_ns", solve_time.count(), " ns");
+                out.end();
+            });
+        };
+        solve("-", std::chrono::nanoseconds(0));
+        for (auto p(file.begin()); p != file.end();) {
+            const auto e(std::find(p, file.end(), '\n'));
+            std::string line(p, e);
+            p = e == file.end() ? e : e + 1;
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == 'c') {
+                continue;
+            }
+            std::istringstream in(line.substr(1));
+            const auto start(std::chrono::steady_clock::now());
+            if (line[0] == 'a') {
+                std::vector<int> clause;
+                for (int l; in >> l && l;) {
+                    clause.push_back(l);
+                }
+                const auto id(solver.add(clause));
+                line += " (clause " + std::to_string(id) + ")";
+            } else if (line[0] == 'd') {
+                std::size_t id;
+                if (!(in >> id)) {
+                    throw std::runtime_error(script + ": bad line '" + line + "'");
+                }
+                solver.remove(id);
+            } else {
+                throw std::runtime_error(script + ": bad line '" + line + "'");
+            }
+            solve(line, std::chrono::steady_clock::now() - start);
+        }
+    });
+};
 
-    std::cout << "UNIVERSAL SAPCE : ";
-    print(sat_space(universal, n), ORDER::DIRECT);
+// --profile: one record per instance on stderr, an NDJSON object or a CSV row
+// (the header before the first one); batch workers print in completion order
+auto print_profile = [](const profile_record &r) {
+    static std::mutex mutex;
+    static bool header(false);
+    writer out;
+    if (config.profile_format == FORMAT::JSON) {
+        record line(out, FORMAT::JSON, BITS::BIN);
+        line.begin(r.instance, "instance");
+        line.field("", "n", r.n);
+        line.field("", "m", r.m);
+        line.field("", "total_ns", r.total.count());
+        auto &phases(line.key("", "phase_ns"));
+        for (std::size_t k(0); k < PHASES; k++) {
+            phases << (k ? ",\"" : "{\"") << phase_name(PHASE(k)) << "\":" << r.phase[k].count();
+        }
+        phases << '}';
+        for (std::size_t k(0); k < COUNTERS; k++) {
+            line.field("", counter_name(COUNTER(k)), r.counter[k]);
+        }
+        line.field("", "peak_rss_kib", r.peak_rss);
+        line.end();
+    } else {
+        out << '"';
+        for (const auto c : r.instance) {
+            out << c;
+            if (c == '"') {
+                out << c;
+            }
+        }
+        out << "\"," << r.n << ',' << r.m << ',' << r.total.count();
+        for (std::size_t k(0); k < PHASES; k++) {
+            out << ',' << r.phase[k].count();
+        }
+        for (std::size_t k(0); k < COUNTERS; k++) {
+            out << ',' << r.counter[k];
+        }
+        out << ',' << r.peak_rss << '\n';
+    }
+    const auto text(out.take());
+    std::lock_guard<std::mutex> lock(mutex);
+    if (config.profile_format == FORMAT::CSV && !header) {
+        std::cerr << "instance,n,m,total_ns";
+        for (std::size_t k(0); k < PHASES; k++) {
+            std::cerr << ',' << phase_name(PHASE(k)) << "_ns";
+        }
+        for (std::size_t k(0); k < COUNTERS; k++) {
+            std::cerr << ',' << counter_name(COUNTER(k));
+        }
+        std::cerr << ",peak_rss_kib\n";
+        header = true;
+    }
+    std::cerr << text;
+};
 
-    std::cout << "2^(n + m)       : " << "2^(" << n << " + " << m << ")" << std::endl;
-    std::cout << "ABS COMPLEXITY  : " << i128tos(complexity) << std::endl;
-    std::cout << std::string(185, '-') << std::endl;
+auto report = [](const formula &cnf, const std::string &formula, writer &to = console(), thread_pool &pool = workers()) {
+    if (!config.profile) {
+        report_any(cnf, formula, to, pool);
+        return;
+    }
+    profile_record r;
+    r.instance = formula;
+    r.n = cnf.n;
+    r.m = cnf.size();
+    {
+        instance_profile p(r, !config.batch && config.serve.empty());
+        report_any(cnf, formula, to, pool);
+        p.finish();
+    }
+    print_profile(r);
 };
 
 void ex_a() {
@@ -132,14 +1102,14 @@ void ex_a() {
     // True   True   False  False
     // True   True   True   False
 
-    std::vector<std::vector<I>> cnf = {{1,  2,  3},
-                                       {1,  2,  -3},
-                                       {1,  -2, 3},
-                                       {1,  -2, -3},
-                                       {-1, 2,  3},
-                                       {-1, 2,  -3},
-                                       {-1, -2, 3},
-                                       {-1, -2, -3}};
+    formula cnf = {{1,  2,  3},
+                   {1,  2,  -3},
+                   {1,  -2, 3},
+                   {1,  -2, -3},
+                   {-1, 2,  3},
+                   {-1, 2,  -3},
+                   {-1, -2, 3},
+                   {-1, -2, -3}};
     report(cnf, "(a&((b|c)^a->c)<->b)&~(a&((b|c)^a->c)<->b)");
 }
 
@@ -163,18 +1133,18 @@ void ex_b() {
     // True   True   True   False  False
     // True   True   True   True   False
 
-    std::vector<std::vector<I>> cnf = {{1,  2,  3,  4},
-                                       {1,  2,  3,  -4},
-                                       {1,  2,  -3, 4},
-                                       {1,  2,  -3, -4},
-                                       {1,  -2, 3,  4},
-                                       {1,  -2, -3, 4},
-                                       {-1, 2,  3,  4},
-                                       {-1, 2,  3,  -4},
-                                       {-1, 2,  -3, 4},
-                                       {-1, -2, 3,  4},
-                                       {-1, -2, -3, 4},
-                                       {-1, -2, -3, -4}};
+    formula cnf = {{1,  2,  3,  4},
+                   {1,  2,  3,  -4},
+                   {1,  2,  -3, 4},
+                   {1,  2,  -3, -4},
+                   {1,  -2, 3,  4},
+                   {1,  -2, -3, 4},
+                   {-1, 2,  3,  4},
+                   {-1, 2,  3,  -4},
+                   {-1, 2,  -3, 4},
+                   {-1, -2, 3,  4},
+                   {-1, -2, -3, 4},
+                   {-1, -2, -3, -4}};
     report(cnf, "(a&((b|c)^a->c)|b)&~(a&((b&c)^a->c)<->b)&d");
 }
 
@@ -214,29 +1184,29 @@ void ex_c() {
     // True   True   True   True   False  True
     // True   True   True   True   True   False
 
-    std::vector<std::vector<I>> cnf = {{1,  2,  3,  4,  5},
-                                       {1,  2,  3,  4,  -5},
-                                       {1,  2,  3,  -4, -5},
-                                       {1,  2,  -3, 4,  5},
-                                       {1,  2,  -3, 4,  -5},
-                                       {1,  2,  -3, -4, -5},
-                                       {1,  -2, 3,  4,  5},
-                                       {1,  -2, 3,  4,  -5},
-                                       {1,  -2, 3,  -4, 5},
-                                       {1,  -2, -3, 4,  5},
-                                       {1,  -2, -3, 4,  -5},
-                                       {1,  -2, -3, -4, 5},
-                                       {-1, 2,  3,  4,  5},
-                                       {-1, 2,  3,  4,  -5},
-                                       {-1, 2,  3,  -4, -5},
-                                       {-1, 2,  -3, 4,  5},
-                                       {-1, 2,  -3, 4,  -5},
-                                       {-1, 2,  -3, -4, 5},
-                                       {-1, -2, 3,  4,  5},
-                                       {-1, -2, 3,  4,  -5},
-                                       {-1, -2, 3,  -4, 5},
-                                       {-1, -2, -3, 4,  -5},
-                                       {-1, -2, -3, -4, -5}};
+    formula cnf = {{1,  2,  3,  4,  5},
+                   {1,  2,  3,  4,  -5},
+                   {1,  2,  3,  -4, -5},
+                   {1,  2,  -3, 4,  5},
+                   {1,  2,  -3, 4,  -5},
+                   {1,  2,  -3, -4, -5},
+                   {1,  -2, 3,  4,  5},
+                   {1,  -2, 3,  4,  -5},
+                   {1,  -2, 3,  -4, 5},
+                   {1,  -2, -3, 4,  5},
+                   {1,  -2, -3, 4,  -5},
+                   {1,  -2, -3, -4, 5},
+                   {-1, 2,  3,  4,  5},
+                   {-1, 2,  3,  4,  -5},
+                   {-1, 2,  3,  -4, -5},
+                   {-1, 2,  -3, 4,  5},
+                   {-1, 2,  -3, 4,  -5},
+                   {-1, 2,  -3, -4, 5},
+                   {-1, -2, 3,  4,  5},
+                   {-1, -2, 3,  4,  -5},
+                   {-1, -2, 3,  -4, 5},
+                   {-1, -2, -3, 4,  -5},
+                   {-1, -2, -3, -4, -5}};
     report(cnf, "(a&((b|c)^a->c)|b)&~(a&((b&c)^a->c)<->b)&d<->(a&b&c|d)->e");
 }
 
@@ -308,61 +1278,61 @@ void ex_d() {
     // True   True   True   True   True   False  True
     // True   True   True   True   True   True   False
 
-    std::vector<std::vector<I>> cnf = {{1,  2,  3,  4,  5,  6},
-                                       {1,  2,  3,  4,  5,  -6},
-                                       {1,  2,  3,  4,  -5, 6},
-                                       {1,  2,  3,  4,  -5, -6},
-                                       {1,  2,  3,  -4, 5,  6},
-                                       {1,  2,  3,  -4, 5,  -6},
-                                       {1,  2,  3,  -4, -5, -6},
-                                       {1,  2,  -3, 4,  5,  6},
-                                       {1,  2,  -3, 4,  5,  -6},
-                                       {1,  2,  -3, 4,  -5, 6},
-                                       {1,  2,  -3, 4,  -5, -6},
-                                       {1,  2,  -3, -4, 5,  6},
-                                       {1,  2,  -3, -4, 5,  -6},
-                                       {1,  2,  -3, -4, -5, -6},
-                                       {1,  -2, 3,  4,  5,  6},
-                                       {1,  -2, 3,  4,  5,  -6},
-                                       {1,  -2, 3,  4,  -5, 6},
-                                       {1,  -2, 3,  4,  -5, -6},
-                                       {1,  -2, 3,  -4, 5,  6},
-                                       {1,  -2, 3,  -4, 5,  -6},
-                                       {1,  -2, 3,  -4, -5, -6},
-                                       {1,  -2, -3, 4,  5,  6},
-                                       {1,  -2, -3, 4,  5,  -6},
-                                       {1,  -2, -3, 4,  -5, 6},
-                                       {1,  -2, -3, 4,  -5, -6},
-                                       {1,  -2, -3, -4, 5,  6},
-                                       {1,  -2, -3, -4, 5,  -6},
-                                       {1,  -2, -3, -4, -5, -6},
-                                       {-1, 2,  3,  4,  5,  6},
-                                       {-1, 2,  3,  4,  5,  -6},
-                                       {-1, 2,  3,  4,  -5, 6},
-                                       {-1, 2,  3,  4,  -5, -6},
-                                       {-1, 2,  3,  -4, 5,  6},
-                                       {-1, 2,  3,  -4, 5,  -6},
-                                       {-1, 2,  3,  -4, -5, -6},
-                                       {-1, 2,  -3, 4,  5,  6},
-                                       {-1, 2,  -3, 4,  5,  -6},
-                                       {-1, 2,  -3, 4,  -5, 6},
-                                       {-1, 2,  -3, 4,  -5, -6},
-                                       {-1, 2,  -3, -4, 5,  6},
-                                       {-1, 2,  -3, -4, 5,  -6},
-                                       {-1, 2,  -3, -4, -5, -6},
-                                       {-1, -2, 3,  4,  5,  6},
-                                       {-1, -2, 3,  4,  5,  -6},
-                                       {-1, -2, 3,  4,  -5, 6},
-                                       {-1, -2, 3,  4,  -5, -6},
-                                       {-1, -2, 3,  -4, 5,  6},
-                                       {-1, -2, 3,  -4, 5,  -6},
-                                       {-1, -2, 3,  -4, -5, -6},
-                                       {-1, -2, -3, 4,  5,  6},
-                                       {-1, -2, -3, 4,  -5, 6},
-                                       {-1, -2, -3, 4,  -5, -6},
-                                       {-1, -2, -3, -4, 5,  6},
-                                       {-1, -2, -3, -4, 5,  -6},
-                                       {-1, -2, -3, -4, -5, -6}};
+    formula cnf = {{1,  2,  3,  4,  5,  6},
+                   {1,  2,  3,  4,  5,  -6},
+                   {1,  2,  3,  4,  -5, 6},
+                   {1,  2,  3,  4,  -5, -6},
+                   {1,  2,  3,  -4, 5,  6},
+                   {1,  2,  3,  -4, 5,  -6},
+                   {1,  2,  3,  -4, -5, -6},
+                   {1,  2,  -3, 4,  5,  6},
+                   {1,  2,  -3, 4,  5,  -6},
+                   {1,  2,  -3, 4,  -5, 6},
+                   {1,  2,  -3, 4,  -5, -6},
+                   {1,  2,  -3, -4, 5,  6},
+                   {1,  2,  -3, -4, 5,  -6},
+                   {1,  2,  -3, -4, -5, -6},
+                   {1,  -2, 3,  4,  5,  6},
+                   {1,  -2, 3,  4,  5,  -6},
+                   {1,  -2, 3,  4,  -5, 6},
+                   {1,  -2, 3,  4,  -5, -6},
+                   {1,  -2, 3,  -4, 5,  6},
+                   {1,  -2, 3,  -4, 5,  -6},
+                   {1,  -2, 3,  -4, -5, -6},
+                   {1,  -2, -3, 4,  5,  6},
+                   {1,  -2, -3, 4,  5,  -6},
+                   {1,  -2, -3, 4,  -5, 6},
+                   {1,  -2, -3, 4,  -5, -6},
+                   {1,  -2, -3, -4, 5,  6},
+                   {1,  -2, -3, -4, 5,  -6},
+                   {1,  -2, -3, -4, -5, -6},
+                   {-1, 2,  3,  4,  5,  6},
+                   {-1, 2,  3,  4,  5,  -6},
+                   {-1, 2,  3,  4,  -5, 6},
+                   {-1, 2,  3,  4,  -5, -6},
+                   {-1, 2,  3,  -4, 5,  6},
+                   {-1, 2,  3,  -4, 5,  -6},
+                   {-1, 2,  3,  -4, -5, -6},
+                   {-1, 2,  -3, 4,  5,  6},
+                   {-1, 2,  -3, 4,  5,  -6},
+                   {-1, 2,  -3, 4,  -5, 6},
+                   {-1, 2,  -3, 4,  -5, -6},
+                   {-1, 2,  -3, -4, 5,  6},
+                   {-1, 2,  -3, -4, 5,  -6},
+                   {-1, 2,  -3, -4, -5, -6},
+                   {-1, -2, 3,  4,  5,  6},
+                   {-1, -2, 3,  4,  5,  -6},
+                   {-1, -2, 3,  4,  -5, 6},
+                   {-1, -2, 3,  4,  -5, -6},
+                   {-1, -2, 3,  -4, 5,  6},
+                   {-1, -2, 3,  -4, 5,  -6},
+                   {-1, -2, 3,  -4, -5, -6},
+                   {-1, -2, -3, 4,  5,  6},
+                   {-1, -2, -3, 4,  -5, 6},
+                   {-1, -2, -3, 4,  -5, -6},
+                   {-1, -2, -3, -4, 5,  6},
+                   {-1, -2, -3, -4, 5,  -6},
+                   {-1, -2, -3, -4, -5, -6}};
     report(cnf, "((a&((b|c)^a->c)|b)->(a&b&c|d)&d<->(a&b&c|d)->e)&~((a&((b|c)^a->c)|b)->(a&b&c|d)&d<->(a&b&c|d)->f)");
 }
 
@@ -434,17 +1404,17 @@ void ex_e() {
     // True   True   True   True   True   False  True
     // True   True   True   True   True   True   False
 
-    std::vector<std::vector<I>> cnf = {{1,  2,  3,  4,  5,  -6},
-                                       {1,  2,  3,  4,  -5, 6},
-                                       {1,  2,  3,  4,  -5, -6},
-                                       {1,  2,  3,  -4, 5,  6},
-                                       {1,  2,  3,  -4, 5,  -6},
-                                       {1,  2,  3,  -4, -5, -6},
-                                       {1,  2,  -3, 4,  5,  6},
-                                       {1,  2,  -3, 4,  5,  -6},
-                                       {1,  2,  -3, 4,  -5, 6},
-                                       {1,  2,  -3, 4,  -5, -6},
-                                       {-1, -2, -3, -4, -5, -6}};
+    formula cnf = {{1,  2,  3,  4,  5,  -6},
+                   {1,  2,  3,  4,  -5, 6},
+                   {1,  2,  3,  4,  -5, -6},
+                   {1,  2,  3,  -4, 5,  6},
+                   {1,  2,  3,  -4, 5,  -6},
+                   {1,  2,  3,  -4, -5, -6},
+                   {1,  2,  -3, 4,  5,  6},
+                   {1,  2,  -3, 4,  5,  -6},
+                   {1,  2,  -3, 4,  -5, 6},
+                   {1,  2,  -3, 4,  -5, -6},
+                   {-1, -2, -3, -4, -5, -6}};
     report(cnf, "(a|b|c|d|e|~f)&(a|b|c|d|~e|f)&(a|b|c|d|~e|~f)&(a|b|c|~d|e|f)&(a|b|c|~d|e|~f)&(a|b|c|~d|~e|~f)&(a|b|~c|d|e|f)&(a|b|~c|d|e|~f)&(a|b|~c|d|~e|f)&(a|b|~c|d|~e|~f)&(~a|~b|~c|~d|~e|~f)");
 }
 
@@ -516,24 +1486,360 @@ void ex_f() {
     // True   True   True   True   True   False  True
     // True   True   True   True   True   True   False
 
-    std::vector<std::vector<I>> cnf = {{1,  2,  3,  4,  5,  -6},
-                                       {1,  2,  3,  4,  -5, 6},
-                                       {1,  2,  3,  4,  -5, -6},
-                                       {1,  2,  -3, 4,  5,  -6},
-                                       {1,  2,  -3, 4,  -5, 6},
-                                       {1,  2,  -3, 4,  -5, -6},
-                                       {-1, -2, -3, -4, -5, -6}};
+    formula cnf = {{1,  2,  3,  4,  5,  -6},
+                   {1,  2,  3,  4,  -5, 6},
+                   {1,  2,  3,  4,  -5, -6},
+                   {1,  2,  -3, 4,  5,  -6},
+                   {1,  2,  -3, 4,  -5, 6},
+                   {1,  2,  -3, 4,  -5, -6},
+                   {-1, -2, -3, -4, -5, -6}};
     report(cnf, "(a|b|c|d|e|~f)&(a|b|c|d|~e|f)&(a|b|c|d|~e|~f)&(a|b|~c|d|e|~f)&(a|b|~c|d|~e|f)&(a|b|~c|d|~e|~f)&(~a|~b|~c|~d|~e|~f)");
 }
 
+auto usage = [](const char *unt) {
+    std::cerr << "usage: " << unt << " [options] [file.cnf | -]..." << std::endl;
+    std::cerr << "  with no files the built-in examples are solved; '-' reads DIMACS from stdin" << std::endl;
+    std::cerr << "  --engine=abs|hs|exhaustive    abstract binary search, exact horowitz-sahni, or phi at every" << std::endl;
+    std::cerr << "                                index of the universe (at most 63 clauses)" << std::endl;
+    std::cerr << "  --matches=k|all               universal indices horowitz-sahni reports, the k least (1)" << std::endl;
+    std::cerr << "  --phi=auto|scan|delta|tables  how abstract_binary_search evaluates phi" << std::endl;
+    std::cerr << "  --phi-memory=MiB              memory cap for the phi tables" << std::endl;
+    std::cerr << "  --probes=P                    phi evaluations per search round, in parallel (1); phi is not" << std::endl;
+    std::cerr << "                                monotone, so with P > 1 the search may end on another index" << std::endl;
+    std::cerr << "                                than the serial one, or on none where that one finds a match" << std::endl;
+    std::cerr << "  --threads=T                   worker threads (all cores)" << std::endl;
+    std::cerr << "  --shards=N                    split the abs search or the exhaustive scan across N worker" << std::endl;
+    std::cerr << "                                processes (not with --cache, --out-of-core, --first-sat," << std::endl;
+    std::cerr << "                                --edits, --batch or --serve); the abs search probes as with" << std::endl;
+    std::cerr << "                                --probes=N, and may end as that does, the scan is exact" << std::endl;
+    std::cerr << "  --batch                       solve the instances in parallel, one per worker;" << std::endl;
+    std::cerr << "                                directories expand to their files" << std::endl;
+    std::cerr << "  --cubes=k                     build the sat space as 2^k cubes over the first k variables" << std::endl;
+    std::cerr << "  --first-sat                   stop at the first cube with a model and print it" << std::endl;
+    std::cerr << "  --preprocess                  simplify the formula first (units, pure literals, subsumption," << std::endl;
+    std::cerr << "                                variable elimination); output stays in the original variables" << std::endl;
+    std::cerr << "  --models=k|all|count          print the first k models, all of them, or only their count," << std::endl;
+    std::cerr << "                                instead of SAT SPACE" << std::endl;
+    std::cerr << "  --out-of-core=DIR             keep the sat space in a file under DIR, mapped and walked" << std::endl;
+    std::cerr << "                                slice by slice (abs engine, phi streamed; not with --probes," << std::endl;
+    std::cerr << "                                --phi, --cubes, --preprocess, --cache, --first-sat or --edits)" << std::endl;
+    std::cerr << "  --resident=MiB                slice size for --out-of-core (256)" << std::endl;
+    std::cerr << "  --format=text|json            labelled lines, or one NDJSON object per instance" << std::endl;
+    std::cerr << "  --space=bin|hex|raw           bit lines as 0/1, hex digits or raw bytes (json: raw is hex)" << std::endl;
+    std::cerr << "  --profile=json|csv            per-instance phase times and counters on stderr" << std::endl;
+    std::cerr << "  --edits=FILE                  solve the one formula again after each clause edit in FILE" << std::endl;
+    std::cerr << "                                ('a <literals> 0' adds, 'd <id>' removes), warm-started" << std::endl;
+    std::cerr << "  --cache=N                     keep the last N results: tables under their canonical cnf," << std::endl;
+    std::cerr << "                                searches under the clauses in the order given (abs engine;" << std::endl;
+    std::cerr << "                                not with --preprocess, --first-sat or --out-of-core)" << std::endl;
+    std::cerr << "  --cache-file=FILE             load the cache from FILE and append new results to it" << std::endl;
+    std::cerr << "  --checkpoint=FILE             save the table tiles and the abs search state to FILE as the" << std::endl;
+    std::cerr << "                                one instance is solved (abs engine; not with --batch, --cache," << std::endl;
+    std::cerr << "                                --edits, --first-sat or --out-of-core); removed when it completes" << std::endl;
+    std::cerr << "  --checkpoint-every=SECONDS    time between checkpoints (60, at least 1); a solve shorter" << std::endl;
+    std::cerr << "                                than it writes none" << std::endl;
+    std::cerr << "  --resume                      continue from the --checkpoint FILE, if there is one" << std::endl;
+    std::cerr << "  --serve=SOCKET                solve jobs sent to a unix domain socket until SIGINT or SIGTERM" << std::endl;
+    std::cerr << "                                ('cnf <id> [ms]' or 'subset-sum <id> [ms]', the input, 'end';" << std::endl;
+    std::cerr << "                                'cancel <id>'), replies streamed back as the jobs finish" << std::endl;
+    std::cerr << "  --queue=N                     jobs --serve holds, waiting or running; a job past them is" << std::endl;
+    std::cerr << "                                answered 'busy <id>' (64)" << std::endl;
+    std::cerr << "  --list=FILE                   add the paths in FILE (one per line, - for stdin)" << std::endl;
+};
+
+// "--name=value" -> value, or nullptr when arg is another option
+auto value_of = [](const char *arg, const char *name) -> const char * {
+    const auto k(std::strlen(name));
+    return !std::strncmp(arg, name, k) && arg[k] == '=' ? arg + k + 1 : nullptr;
+};
+
+// bench.cpp builds on everything above with its own main
+#ifndef UNT_NO_MAIN
 int main(int argc, char *argv[]) {
+    std::vector<std::string> paths;
+    for (auto i(1); i < argc; i++) {
+        if (!std::strcmp(argv[i], "-h") || !std::strcmp(argv[i], "--help")) {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (auto v = value_of(argv[i], "--engine")) {
+            const std::string engine(v);
+            if (engine == "abs" || engine == "hs" || engine == "exhaustive") {
+                config.engine = engine == "hs" ? ENGINE::HS : engine == "exhaustive" ? ENGINE::EXHAUSTIVE : ENGINE::ABS;
+                continue;
+            }
+        }
+        if (auto v = value_of(argv[i], "--matches")) {
+            config.matches = std::string(v) == "all" ? 0 : std::strtoull(v, nullptr, 10);
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--phi")) {
+            const std::string mode(v);
+            if (mode == "auto" || mode == "scan" || mode == "delta" || mode == "tables") {
+                config.phi = mode == "scan" ? PHI::SCAN : mode == "delta" ? PHI::DELTA : mode == "tables" ? PHI::TABLES : PHI::AUTO;
+                continue;
+            }
+        }
+        if (auto v = value_of(argv[i], "--phi-memory")) {
+            config.phi_memory = std::strtoull(v, nullptr, 10) << 20;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--probes")) {
+            config.probes = std::max<std::size_t>(std::strtoull(v, nullptr, 10), 1);
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--shards")) {
+            config.shards = std::strtoull(v, nullptr, 10);
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--threads")) {
+            config.threads = std::strtoull(v, nullptr, 10);
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--cubes")) {
+            config.cubes = std::strtoull(v, nullptr, 10);
+            continue;
+        }
+        if (!std::strcmp(argv[i], "--first-sat")) {
+            config.first_sat = true;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--models")) {
+            const std::string models(v);
+            config.listing = models == "count" ? LISTING::COUNT : LISTING::MODELS;
+            config.models = models == "all" || models == "count" ? 0 : std::strtoull(v, nullptr, 10);
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--out-of-core")) {
+            config.out_of_core = v;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--resident")) {
+            config.resident = std::max<std::size_t>(std::strtoull(v, nullptr, 10), 1) << 20;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--format")) {
+            const std::string format(v);
+            if (format == "text" || format == "json") {
+                config.format = format == "json" ? FORMAT::JSON : FORMAT::TEXT;
+                continue;
+            }
+        }
+        if (auto v = value_of(argv[i], "--space")) {
+            const std::string space(v);
+            if (space == "bin" || space == "hex" || space == "raw") {
+                config.bits = space == "hex" ? BITS::HEX : space == "raw" ? BITS::RAW : BITS::BIN;
+                continue;
+            }
+        }
+        if (auto v = value_of(argv[i], "--profile")) {
+            const std::string format(v);
+            if (format == "json" || format == "csv") {
+#ifdef UNT_NO_PROFILE
+                std::cerr << argv[0] << ": built with UNT_NO_PROFILE, --profile is not available" << std::endl;
+                return EXIT_FAILURE;
+#endif
+                config.profile = true;
+                config.profile_format = format == "csv" ? FORMAT::CSV : FORMAT::JSON;
+                continue;
+            }
+        }
+        if (auto v = value_of(argv[i], "--edits")) {
+            config.edits = v;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--cache")) {
+            config.cache = std::strtoull(v, nullptr, 10);
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--cache-file")) {
+            config.cache_file = v;
+            config.cache = config.cache ? config.cache : 1024;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--checkpoint")) {
+            config.checkpoint = v;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--checkpoint-every")) {
+            config.checkpoint_every = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(std::strtod(v, nullptr)));
+            continue;
+        }
+        if (!std::strcmp(argv[i], "--resume")) {
+            config.resume = true;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--serve")) {
+            config.serve = v;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--queue")) {
+            config.queue = std::max<std::size_t>(std::strtoull(v, nullptr, 10), 1);
+            continue;
+        }
+        if (!std::strcmp(argv[i], "--preprocess")) {
+            config.preprocess = true;
+            continue;
+        }
+        if (!std::strcmp(argv[i], "--batch")) {
+            config.batch = true;
+            continue;
+        }
+        if (auto v = value_of(argv[i], "--list")) {
+            try {
+                read_list(v, paths);
+            } catch (const std::exception &e) {
+                std::cerr << argv[0] << ": " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+        if (argv[i][0] == '-' && argv[i][1]) {
+            std::cerr << argv[0] << ": unknown option " << argv[i] << std::endl;
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (config.batch) {
+            expand_directory(argv[i], paths);
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+#ifdef _OPENMP
+    if (config.threads) {
+        omp_set_num_threads(static_cast<int>(config.threads));
+    }
+#endif
+
+    if (config.shards && (config.engine == ENGINE::HS || config.batch || !config.serve.empty() || config.cache || !config.edits.empty() ||
+                          config.first_sat || !config.out_of_core.empty())) {
+        std::cerr << argv[0] << ": --shards is for the abs and exhaustive engines, without --batch, --serve, --cache, --edits, --first-sat"
+                  << " or --out-of-core" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!config.out_of_core.empty() && (config.engine != ENGINE::ABS || config.probes > 1 || config.phi != PHI::AUTO || config.cubes ||
+                                         config.preprocess || config.cache || config.first_sat || !config.edits.empty())) {
+        std::cerr << argv[0] << ": --out-of-core is for the abs engine, without --probes, --phi, --cubes, --preprocess, --cache, --first-sat"
+                  << " or --edits" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (config.resume && config.checkpoint.empty()) {
+        std::cerr << argv[0] << ": --resume needs --checkpoint=FILE" << std::endl;
+        return EXIT_FAILURE;
+    }
+    // the hs merge and the exhaustive scan never snapshot: a resumed run would
+    // start them over
+    if (!config.checkpoint.empty() && (paths.size() != 1 || config.engine != ENGINE::ABS || config.batch || config.cache || !config.edits.empty() ||
+                                        config.first_sat || !config.out_of_core.empty())) {
+        std::cerr << argv[0] << ": --checkpoint is for one instance on the abs engine, without --batch, --cache, --edits, --first-sat"
+                  << " or --out-of-core" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (config.cache) {
+        try {
+            results();
+        } catch (const std::exception &e) {
+            std::cerr << argv[0] << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!config.serve.empty()) {
+        if (!paths.empty() || config.batch || !config.edits.empty()) {
+            std::cerr << argv[0] << ": --serve takes its instances from the socket, without files, --batch or --edits" << std::endl;
+            return EXIT_FAILURE;
+        }
+        try {
+            const auto threads(config.threads ? config.threads : std::thread::hardware_concurrency());
+            run_server<batch_scratch>(config.serve, threads, config.queue, [](const server_job &job, batch_scratch &s) {
+#ifdef _OPENMP
+                omp_set_num_threads(1);
+#endif
+                if (job.kind == "cnf") {
+                    const auto cnf(parse_dimacs(job.body.data(), job.body.data() + job.body.size()));
+                    if (cnf.n > 63) {
+                        throw std::runtime_error(std::to_string(cnf.n) + " variables, at most 63 are supported");
+                    }
+                    report(cnf, job.id, s.out, s.lanes);
+                    return;
+                }
+                std::istringstream in(job.body);
+                word t;
+                if (!(in >> t)) {
+                    throw std::runtime_error("subset-sum: expected the target");
+                }
+                scratch_vector<word> values;
+                for (word v; in >> v;) {
+                    values.push_back(v);
+                }
+                if (!in.eof()) {
+                    throw std::runtime_error("subset-sum: expected a number");
+                }
+                report_subset_sum(values, t, job.id, s.out, s.lanes);
+            });
+        } catch (const std::exception &e) {
+            std::cerr << argv[0] << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (paths.empty()) {
+        try {
+            ex_a();
+            ex_b();
+            ex_c();
+            ex_d();
+            ex_e();
+            ex_f();
+        } catch (const std::exception &e) {
+            console().flush();
+            std::cerr << argv[0] << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    auto solve = [&](const std::string &path, writer &out, thread_pool &pool) {
+        try {
+            const auto cnf(load_dimacs(path));
+            if (cnf.n > 63) {
+                throw std::runtime_error(path + ": " + std::to_string(cnf.n) + " variables, at most 63 are supported");
+            }
+            if (config.edits.empty()) {
+                report(cnf, path, out, pool);
+            } else {
+                report_edits(cnf, path, config.edits, out);
+            }
+            return true;
+        } catch (const std::exception &e) {
+            out.flush();
+            std::cerr << argv[0] << ": " << e.what() << std::endl;
+            return false;
+        }
+    };
 
-    ex_a();
-    ex_b();
-    ex_c();
-    ex_d();
-    ex_e();
-    ex_f();
+    if (config.batch) {
+        const auto threads(config.threads ? config.threads : std::thread::hardware_concurrency());
+        const auto summary(run_batch<batch_scratch>(paths, threads, std::cout, [&](const std::string &path, batch_scratch &s) {
+#ifdef _OPENMP
+            omp_set_num_threads(1);
+#endif
+            return solve(path, s.out, s.lanes);
+        }));
+        std::cerr << "BATCH           : " << summary.instances << " instances, " << summary.failed << " failed, "
+                  << summary.elapsed.count() << " s, " << summary.instances / summary.elapsed.count() << " instances/s" << std::endl;
+        return summary.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    for (const auto &path : paths) {
+        if (!solve(path, console(), workers())) {
+            return EXIT_FAILURE;
+        }
+    }
 
     return EXIT_SUCCESS;
 }
+#endif
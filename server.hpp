@@ -0,0 +1,353 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_SERVER_HPP
+#define UNT_SERVER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "deadline.hpp"
+#include "pool.hpp"
+
+// --serve: a long-lived solver on a unix domain socket. a client sends
+// requests, one header line each:
+//
+//   cnf <id> [<ms>]          a DIMACS formula follows, up to a line "end"
+//   subset-sum <id> [<ms>]   the target and then the values follow, up to "end"
+//   cancel <id>              stops the job <id> of this connection
+//
+// and gets one reply per job, in the order the jobs finish:
+//
+//   ok <id> <bytes>          the record of the job (--format) follows
+//   stopped <id> <reason>    cancelled, or its deadline of <ms> passed
+//   busy <id>                the queue was full: the job was not taken
+//   error <id> <message>
+//
+// the deadline runs from the end of the request, so time spent queued counts.
+// a job polls it between search rounds and table tiles.
+//
+// the jobs of every connection share one task_pool, each worker with its own
+// S scratch as in run_batch. at most `capacity` jobs wait or run at a time; one
+// past them is answered busy at once, so the reader of a connection never
+// waits for a slot and a cancel is read as soon as it comes. a request body
+// past server_request_limit bytes is answered error and dropped, a line past
+// it ends the connection. SIGINT or SIGTERM stop the server: the running jobs
+// are cancelled and answered, the socket file is removed.
+
+constexpr std::size_t server_request_limit = std::size_t(64) << 20;
+
+struct server_job {
+    std::string id, kind, body;
+};
+
+// the slots of the queue: none is taken while `capacity` jobs are out
+class job_slots {
+public:
+    explicit job_slots(std::size_t capacity) : free(std::max<std::size_t>(capacity, 1)) {}
+
+    bool try_acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free) {
+            return false;
+        }
+        free--;
+        return true;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        free++;
+    }
+
+private:
+    std::mutex mutex;
+    std::size_t free;
+};
+
+// one client: replies are written whole under the lock; a client gone makes
+// its jobs stop
+class server_connection {
+public:
+    explicit server_connection(int fd) : fd(fd) {}
+
+    server_connection(const server_connection &) = delete;
+
+    server_connection &operator=(const server_connection &) = delete;
+
+    ~server_connection() { ::close(fd); }
+
+    void send(const std::string &reply) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t done(0); !gone && done < reply.size();) {
+            const auto r(::send(fd, reply.data() + done, reply.size() - done, MSG_NOSIGNAL));
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            if (r <= 0) {
+                gone = true;
+                for (auto &j : jobs) {
+                    j.second->cancel();
+                }
+                break;
+            }
+            done += r;
+        }
+    }
+
+    // false when a job of that id is still out
+    bool start(const std::string &id, const std::shared_ptr<deadline> &stop) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (gone) {
+            stop->cancel();
+        }
+        return jobs.emplace(id, stop).second;
+    }
+
+    void finish(const std::string &id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.erase(id);
+    }
+
+    void cancel(const std::string &id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto j(jobs.find(id));
+        if (j != jobs.end()) {
+            j->second->cancel();
+        }
+    }
+
+    void cancel_all() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &j : jobs) {
+            j.second->cancel();
+        }
+    }
+
+    const int fd;
+    std::thread reader;
+    std::atomic<bool> closed{false};
+
+private:
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<deadline>> jobs;
+    bool gone = false;
+};
+
+// write end of the pipe the signal handler wakes the accept loop with
+inline int &server_wake() {
+    static int fd(-1);
+    return fd;
+}
+
+extern "C" inline void server_signal(int) {
+    const char c(0);
+    if (::write(server_wake(), &c, 1) < 0) {
+        // nothing to do: the loop is already awake
+    }
+}
+
+// solve(job, scratch) writes the record of the job into scratch, whose take()
+// hands it over; it throws job_stopped when the deadline of its thread stops it
+template<typename S, typename F>
+void run_server(const std::string &path, std::size_t threads, std::size_t capacity, F &&solve) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error(path + ": socket path too long");
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    const auto listener(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (listener < 0) {
+        throw std::runtime_error(path + ": cannot create the socket");
+    }
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) || ::listen(listener, 64)) {
+        ::close(listener);
+        throw std::runtime_error(path + ": cannot listen");
+    }
+    int wake[2];
+    if (::pipe(wake)) {
+        ::close(listener);
+        throw std::runtime_error("cannot create a pipe");
+    }
+    server_wake() = wake[1];
+    std::signal(SIGINT, server_signal);
+    std::signal(SIGTERM, server_signal);
+
+    task_pool pool(threads);
+    std::vector<S> scratch(pool.size());
+    job_slots slots(capacity);
+    std::list<std::shared_ptr<server_connection>> connections;
+
+    auto submit = [&](const std::shared_ptr<server_connection> &c, server_job job, std::chrono::milliseconds limit) {
+        auto stop(limit.count() ? std::make_shared<deadline>(deadline::clock::now() + limit) : std::make_shared<deadline>());
+        if (!slots.try_acquire()) {
+            c->send("busy " + job.id + "\n");
+            return;
+        }
+        if (!c->start(job.id, stop)) {
+            slots.release();
+            c->send("error " + job.id + " a job of this id is running\n");
+            return;
+        }
+        pool.submit([&, c, stop, job](std::size_t worker) {
+            auto &s(scratch[worker]);
+            std::string reply;
+            try {
+                stop->check();
+                deadline::scope in(*stop);
+                solve(job, s);
+                const auto text(s.take());
+                reply = "ok " + job.id + " " + std::to_string(text.size()) + "\n" + text;
+            } catch (const job_stopped &e) {
+                s.take();
+                reply = "stopped " + job.id + " " + e.what() + "\n";
+            } catch (const std::exception &e) {
+                s.take();
+                reply = "error " + job.id + " " + e.what() + "\n";
+            }
+            c->finish(job.id);
+            c->send(reply);
+            slots.release();
+        });
+    };
+
+    // the requests of one connection, until it closes its end
+    auto serve = [&](const std::shared_ptr<server_connection> &c) {
+        std::string buffer, line;
+        server_job job;
+        std::chrono::milliseconds limit(0);
+        bool body(false), over(false);
+        char chunk[1 << 16];
+        for (;;) {
+            const auto r(::recv(c->fd, chunk, sizeof(chunk), 0));
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            if (r <= 0) {
+                break;
+            }
+            buffer.append(chunk, r);
+            std::size_t p(0);
+            for (std::size_t e; (e = buffer.find('\n', p)) != std::string::npos; p = e + 1) {
+                line.assign(buffer, p, e - p);
+                while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+                    line.pop_back();
+                }
+                if (body) {
+                    if (line == "end") {
+                        if (over) {
+                            c->send("error " + job.id + " request over " + std::to_string(server_request_limit) + " bytes\n");
+                        } else {
+                            submit(c, std::move(job), limit);
+                        }
+                        job = server_job();
+                        body = over = false;
+                    } else if (over || job.body.size() + line.size() >= server_request_limit) {
+                        std::string().swap(job.body);
+                        over = true;
+                    } else {
+                        job.body += line;
+                        job.body += '\n';
+                    }
+                    continue;
+                }
+                if (line.empty()) {
+                    continue;
+                }
+                std::istringstream in(line);
+                std::string command, id;
+                in >> command >> id;
+                long ms(0);
+                if ((command == "cnf" || command == "subset-sum") && !id.empty() && (in >> ms || in.eof()) && ms >= 0) {
+                    job.id = id;
+                    job.kind = command;
+                    limit = std::chrono::milliseconds(ms);
+                    body = true;
+                } else if (command == "cancel" && !id.empty()) {
+                    c->cancel(id);
+                } else {
+                    c->send("error " + (id.empty() ? std::string("-") : id) + " bad request '" + line + "'\n");
+                }
+            }
+            buffer.erase(0, p);
+            if (buffer.size() > server_request_limit) {
+                c->send("error - line over " + std::to_string(server_request_limit) + " bytes\n");
+                ::shutdown(c->fd, SHUT_RD);
+                break;
+            }
+        }
+        c->closed = true;
+    };
+
+    for (;;) {
+        pollfd fds[2] = {{listener, POLLIN, 0}, {wake[0], POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        const auto fd(::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC));
+        if (fd < 0) {
+            continue;
+        }
+        for (auto c(connections.begin()); c != connections.end();) {
+            if ((*c)->closed) {
+                (*c)->reader.join();
+                c = connections.erase(c);
+            } else {
+                c++;
+            }
+        }
+        auto c(std::make_shared<server_connection>(fd));
+        c->reader = std::thread(serve, c);
+        connections.push_back(c);
+    }
+
+    for (const auto &c : connections) {
+        ::shutdown(c->fd, SHUT_RD);
+        c->cancel_all();
+    }
+    for (const auto &c : connections) {
+        c->reader.join();
+        c->cancel_all();
+    }
+    pool.wait();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    ::close(wake[0]);
+    ::close(wake[1]);
+    ::close(listener);
+    ::unlink(path.c_str());
+}
+
+#endif
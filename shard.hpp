@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_SHARD_HPP
+#define UNT_SHARD_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "limbs.hpp"
+
+// --shards: worker processes on this host. the coordinator forks them once the
+// table, the universe and the phi tables are built, so every worker reads them
+// copy-on-write and nothing of the instance crosses a socket; what does is a
+// range of indices (or one probe point) per request and its result and
+// counters per reply, over one socketpair per worker. a message is its word
+// count and then the words. the coordinator hands out the next range to
+// whichever worker answers first, which is all the rebalancing there is.
+//
+// a worker never returns into the program it was forked from (its threads
+// are not there): it answers until the coordinator closes its end, then
+// _exits. a worker gone makes the coordinator throw.
+class shard_pool {
+public:
+    // serve(request, reply) answers the requests in each worker
+    template<typename F>
+    shard_pool(std::size_t workers, F &&serve) {
+        for (std::size_t k(0); k < workers; k++) {
+            int pair[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair)) {
+                stop();
+                throw std::runtime_error("shards: cannot create a socketpair");
+            }
+            const auto pid(::fork());
+            if (pid < 0) {
+                ::close(pair[0]);
+                ::close(pair[1]);
+                stop();
+                throw std::runtime_error("shards: cannot fork");
+            }
+            if (!pid) {
+                for (const auto fd : fds) {
+                    ::close(fd);
+                }
+                ::close(pair[0]);
+                work(pair[1], serve);
+            }
+            ::close(pair[1]);
+            fds.push_back(pair[0]);
+            pids.push_back(pid);
+        }
+    }
+
+    shard_pool(const shard_pool &) = delete;
+
+    shard_pool &operator=(const shard_pool &) = delete;
+
+    ~shard_pool() { stop(); }
+
+    std::size_t size() const { return fds.size(); }
+
+    void send(std::size_t k, const std::vector<word> &message) {
+        if (!put(fds[k], message)) {
+            throw std::runtime_error("shards: worker " + std::to_string(k) + " is gone");
+        }
+    }
+
+    std::vector<word> receive(std::size_t k) {
+        std::vector<word> message;
+        if (!get(fds[k], message)) {
+            throw std::runtime_error("shards: worker " + std::to_string(k) + " is gone");
+        }
+        return message;
+    }
+
+    // a worker of `busy` (one flag per worker) whose reply is in
+    std::size_t ready(const std::vector<char> &busy) {
+        std::vector<pollfd> waiting;
+        std::vector<std::size_t> which;
+        for (std::size_t k(0); k < fds.size(); k++) {
+            if (busy[k]) {
+                waiting.push_back({fds[k], POLLIN, 0});
+                which.push_back(k);
+            }
+        }
+        for (;;) {
+            if (::poll(waiting.data(), waiting.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("shards: poll failed");
+            }
+            for (std::size_t k(0); k < waiting.size(); k++) {
+                if (waiting[k].revents) {
+                    return which[k];
+                }
+            }
+        }
+    }
+
+private:
+    template<typename F>
+    [[noreturn]] static void work(int fd, F &serve) {
+        std::vector<word> request, reply;
+        try {
+            while (get(fd, request)) {
+                reply.clear();
+                serve(request, reply);
+                if (!put(fd, reply)) {
+                    break;
+                }
+            }
+        } catch (...) {
+            ::_exit(1);
+        }
+        ::_exit(0);
+    }
+
+    static bool put(int fd, const std::vector<word> &message) {
+        const std::uint64_t k(message.size());
+        return io(fd, const_cast<std::uint64_t *>(&k), sizeof(k), true) &&
+               io(fd, const_cast<word *>(message.data()), k * sizeof(word), true);
+    }
+
+    static bool get(int fd, std::vector<word> &message) {
+        std::uint64_t k(0);
+        if (!io(fd, &k, sizeof(k), false)) {
+            return false;
+        }
+        message.resize(k);
+        return io(fd, message.data(), k * sizeof(word), false);
+    }
+
+    static bool io(int fd, void *p, std::size_t bytes, bool out) {
+        auto c(static_cast<char *>(p));
+        for (std::size_t done(0); done < bytes;) {
+            const auto r(out ? ::send(fd, c + done, bytes - done, MSG_NOSIGNAL) : ::recv(fd, c + done, bytes - done, 0));
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            if (r <= 0) {
+                return false;
+            }
+            done += r;
+        }
+        return true;
+    }
+
+    void stop() {
+        for (const auto fd : fds) {
+            ::close(fd);
+        }
+        for (const auto pid : pids) {
+            while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+            }
+        }
+        fds.clear();
+        pids.clear();
+    }
+
+    std::vector<int> fds;
+    std::vector<pid_t> pids;
+};
+
+#endif
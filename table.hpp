@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_TABLE_HPP
+#define UNT_TABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "arena.hpp"
+#include "deadline.hpp"
+#include "limbs.hpp"
+
+// bit-parallel clause falsification table. bit k of the table is set when the
+// assignment encoded by k falsifies some clause, i.e. the same bit sat_equation
+// used to add as 2^e, but built with word operations and OR, so duplicated or
+// overlapping clauses no longer carry into their neighbours.
+
+// bit k of var_mask[p] is bit p of k (p < 6, inside one word)
+constexpr word var_mask[6] = {0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+                              0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull};
+
+// the set of indices k with (k & care) == value
+struct cube {
+    word care;
+    word value;
+};
+
+// clause -> the indices that falsify it: a positive literal fixes its bit to 1,
+// a negative one to 0 (variable v sits at bit n - v, as in sat_equation). a
+// tautology has no such cube: clause_term below is what callers build from
+template<typename C>
+cube clause_cube(const C &clause, const std::size_t &n) {
+    cube c{0, 0};
+    for (const auto &l : clause) {
+        const auto p(n - static_cast<std::size_t>(l > 0 ? l : -l));
+        c.care |= word(1) << p;
+        c.value |= l > 0 ? word(1) << p : word(0);
+    }
+    return c;
+}
+
+constexpr std::size_t table_words(const std::size_t &n) {
+    return n < 6 ? 1 : std::size_t(1) << (n - 6);
+}
+
+// the table kernels below are compiled once for every n up to kernel_vars, with
+// the table width, the tile and the loop trip counts constant, and once more
+// for larger n taken at runtime. with_vars picks the instance.
+constexpr std::size_t kernel_vars = 16;
+
+template<std::size_t V>
+struct fixed_vars {
+    static constexpr std::size_t value = V;
+};
+
+struct runtime_vars {
+    std::size_t value;
+};
+
+template<std::size_t V = 0, typename F>
+void with_vars(std::size_t n, F &&f) {
+    if constexpr (V > kernel_vars) {
+        f(runtime_vars{n});
+    } else if (n == V) {
+        f(fixed_vars<V>());
+    } else {
+        with_vars<V + 1>(n, std::forward<F>(f));
+    }
+}
+
+// the cube split at bit 6: a fixed in-word pattern and a constraint on the word
+// index. it doubles as the universe term of a clause (the number whose set
+// bits are the cube); low == 0 is the zero term. care holds every index bit
+// past the table, so the term stays inside its 2^n bits however wide the sum
+// it is added to.
+struct cube_words {
+    word low;
+    word care;
+    word value;
+};
+
+inline cube_words split(const cube &c, const std::size_t &n) {
+    cube_words r{~word(0), (c.care >> 6) | ~word(table_words(n) - 1), (c.value & c.care) >> 6};
+    for (std::size_t p(0); p < 6; p++) {
+        if ((c.care >> p) & 1) {
+            r.low &= (c.value >> p) & 1 ? var_mask[p] : ~var_mask[p];
+        }
+    }
+    if (n < 6) {
+        r.low &= (word(1) << (std::size_t(1) << n)) - 1;
+    }
+    return r;
+}
+
+// the universe term of a clause: its cube, or the zero term when the clause
+// holds both v and -v (a tautology, never falsified) and has no cube
+template<typename C>
+cube_words clause_term(const C &clause, const std::size_t &n) {
+    const auto c(clause_cube(clause, n));
+    for (const auto &l : clause) {
+        if (((c.value >> (n - static_cast<std::size_t>(l > 0 ? l : -l))) & 1) != (l > 0)) {
+            return cube_words{0, 0, 0};
+        }
+    }
+    return split(c, n);
+}
+
+// phi of m clause terms in bits: the 2^n of the table, and the carries of
+// adding m numbers of that width (a full table each, at worst)
+inline std::size_t sum_width(const std::size_t &n, const std::size_t &m) {
+    std::size_t carry(0);
+    while (carry < 64 && m >> carry) {
+        carry++;
+    }
+    return (std::size_t(1) << n) + carry;
+}
+
+// d[w] |= c.low for every w in [lo, lo + len) whose index matches the cube
+inline void or_scan(word *d, std::size_t lo, std::size_t len, const cube_words &c) {
+    std::size_t w(0);
+#if defined(__AVX512F__)
+    const auto care(_mm512_set1_epi64(c.care)), value(_mm512_set1_epi64(c.value)), low(_mm512_set1_epi64(c.low));
+    auto idx(_mm512_add_epi64(_mm512_set1_epi64(lo), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7)));
+    for (; w + 8 <= len; w += 8) {
+        const auto m(_mm512_cmpeq_epi64_mask(_mm512_and_si512(idx, care), value));
+        const auto x(_mm512_loadu_si512(d + w));
+        _mm512_storeu_si512(d + w, _mm512_mask_or_epi64(x, m, x, low));
+        idx = _mm512_add_epi64(idx, _mm512_set1_epi64(8));
+    }
+#elif defined(__AVX2__)
+    const auto care(_mm256_set1_epi64x(c.care)), value(_mm256_set1_epi64x(c.value)), low(_mm256_set1_epi64x(c.low));
+    auto idx(_mm256_add_epi64(_mm256_set1_epi64x(lo), _mm256_setr_epi64x(0, 1, 2, 3)));
+    for (; w + 4 <= len; w += 4) {
+        const auto m(_mm256_cmpeq_epi64(_mm256_and_si256(idx, care), value));
+        const auto p(reinterpret_cast<__m256i *>(d + w));
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_loadu_si256(p), _mm256_and_si256(m, low)));
+        idx = _mm256_add_epi64(idx, _mm256_set1_epi64x(4));
+    }
+#endif
+    for (auto p(d + w), e(d + len); p < e; p++) {
+        *p |= ((lo + (p - d)) & c.care) == c.value ? c.low : 0;
+    }
+}
+
+// same as or_scan, but only visits the matching words: 2^(free bits) of them
+inline void or_enumerate(word *d, std::size_t len, const cube_words &c) {
+    const word free(~c.care & (len - 1)), base(c.value & (len - 1));
+    word s(0);
+    do {
+        d[base | s] |= c.low;
+        s = (s - free) & free;
+    } while (s);
+}
+
+// d[w] &= ~c.low for every word w that matches the cube
+inline void clear_enumerate(word *d, std::size_t len, const cube_words &c) {
+    const word free(~c.care & (len - 1)), base(c.value & (len - 1));
+    word s(0);
+    do {
+        d[base | s] &= ~c.low;
+        s = (s - free) & free;
+    } while (s);
+}
+
+// s += the number whose set bits are the cube, one carry chain per matching word
+template<std::size_t W>
+void accumulate(limbs<W> &s, const cube_words &c) {
+    if (!c.low) {
+        return;
+    }
+    const word free(~c.care);
+    word k(0);
+    do {
+        s.add_word(c.low, c.value | k);
+        k = (k - free) & free;
+    } while (k);
+}
+
+template<std::size_t W>
+void retract(limbs<W> &s, const cube_words &c) {
+    if (!c.low) {
+        return;
+    }
+    const word free(~c.care);
+    word k(0);
+    do {
+        s.sub_word(c.low, c.value | k);
+        k = (k - free) & free;
+    } while (k);
+}
+
+template<std::size_t W>
+std::size_t term_words(const limbs<W> &, const cube_words &c) {
+    return c.low ? std::size_t(1) << __builtin_popcountll(~c.care) : 0;
+}
+
+// tiles of 2^12 words (32 KiB) are the unit of work for the threads; a table
+// of one tile is built on the calling thread
+inline std::size_t table_tile(const std::size_t &n) {
+    return std::min<std::size_t>(table_words(n), 4096);
+}
+
+inline std::size_t table_tiles(const std::size_t &n) {
+    return table_words(n) / table_tile(n);
+}
+
+// tiles [from, to) of the table
+template<typename V>
+void falsification_kernel(const scratch_vector<cube_words> &cubes, V vars, word *d, std::size_t from, std::size_t to) {
+    const auto words(table_words(vars.value));
+    const auto tile(std::min<std::size_t>(words, 4096));
+    const auto bits(__builtin_ctzll(tile));
+    to = std::min(to, words / tile);
+#pragma omp parallel for schedule(static) if (to - from > 1)
+    for (std::ptrdiff_t t = from; t < static_cast<std::ptrdiff_t>(to); t++) {
+        const std::size_t lo(t * tile);
+        for (const auto &c : cubes) {
+            if (!c.low || (lo ^ c.value) & c.care & ~word(tile - 1)) {
+                continue;
+            }
+            if (__builtin_popcountll(~c.care & (tile - 1)) + 2 < bits) {
+                or_enumerate(d + lo, tile, c);
+            } else {
+                or_scan(d + lo, lo, tile, c);
+            }
+        }
+    }
+}
+
+// ORs tiles [from, to) of the clauses into a table (a checkpointed build
+// resumes at a tile)
+template<typename T>
+void falsification_tiles(const scratch_vector<cube_words> &cubes, const std::size_t &n, T &table, std::size_t from, std::size_t to) {
+    with_vars(n, [&](auto vars) {
+        // instances wider than a fixed-size table are never reached
+        if (table_words(vars.value) <= table.size()) {
+            falsification_kernel(cubes, vars, table.data(), from, to);
+        }
+    });
+}
+
+// under a deadline the tiles go 64 (2 MiB) at a time, polled in between
+template<typename T>
+void falsification_table(const scratch_vector<cube_words> &cubes, const std::size_t &n, T &table) {
+    table.clear();
+    const auto tiles(table_tiles(n));
+    const auto step(deadline::current() ? std::size_t(64) : tiles);
+    for (std::size_t t(0); t < tiles; t += step) {
+        deadline::poll();
+        falsification_tiles(cubes, n, table, t, std::min(tiles, t + step));
+    }
+}
+
+// popcount of the table; threads only past one tile
+template<typename T, typename V>
+word falsified(const T &table, V vars) {
+    const auto words(table_words(vars.value));
+    word c(0);
+#pragma omp parallel for reduction(+:c) schedule(static) if (words > 4096)
+    for (std::ptrdiff_t w = 0; w < static_cast<std::ptrdiff_t>(words); w++) {
+        c += __builtin_popcountll(table[w]);
+    }
+    return c;
+}
+
+// number of assignments that falsify no clause
+template<typename T>
+word model_count(const T &table, const std::size_t &n) {
+    word c(0);
+    with_vars(n, [&](auto vars) { c = falsified(table, vars); });
+    return (word(1) << n) - c;
+}
+
+#endif
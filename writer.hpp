@@ -0,0 +1,391 @@
+///////////////////////////////////////////////////////////////////////////////
+//   copyright (complexity) 2012-2018 Oscar Riveros. all rights reserved.    //
+//                           oscar.riveros@peqnp.com                         //
+//                                                                           //
+//   without any restriction, Oscar Riveros reserved rights, patents and     //
+//  commercialization of this knowledge or derived directly from this work.  //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNT_WRITER_HPP
+#define UNT_WRITER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "limbs.hpp"
+
+// buffered output. a writer owns one buffer for its whole life; it reaches the
+// stream only when full or on flush(), never per line. without a stream it just
+// grows, and take() hands the text over (a batch instance).
+//
+// a bit line is printed in one of three forms: '0'/'1' per bit, one hex digit
+// per 4 characters of that line, or raw bytes of 8 characters each, the first
+// character in the high bit.
+//
+// a record is one instance's report on top of a writer: labelled lines between
+// the EXAMPLE header and a rule (TEXT), or one NDJSON object (JSON), in which a
+// label repeated in a row (the models, the horowitz-sahni matches) is an array
+// and bit lines are strings (RAW falls back to HEX there).
+
+enum ORDER {
+    DIRECT,
+    INVERSE
+};
+
+enum BITS {
+    BIN,
+    HEX,
+    RAW
+};
+
+enum FORMAT {
+    TEXT,
+    JSON,
+    CSV
+};
+
+// byte b -> its 8 bits as '0'/'1', most significant first, in memory order
+inline const std::array<word, 256> &bit_chars() {
+    static const auto chars = [] {
+        std::array<word, 256> t{};
+        for (std::size_t b(0); b < 256; b++) {
+            for (std::size_t i(0); i < 8; i++) {
+                t[b] |= word((b >> (7 - i)) & 1 ? '1' : '0') << (8 * i);
+            }
+        }
+        return t;
+    }();
+    return chars;
+}
+
+inline word reverse_bits(word w) {
+    w = (w >> 1 & 0x5555555555555555ull) | (w & 0x5555555555555555ull) << 1;
+    w = (w >> 2 & 0x3333333333333333ull) | (w & 0x3333333333333333ull) << 2;
+    w = (w >> 4 & 0x0F0F0F0F0F0F0F0Full) | (w & 0x0F0F0F0F0F0F0F0Full) << 4;
+    return __builtin_bswap64(w);
+}
+
+class writer {
+public:
+    explicit writer(std::ostream *out = nullptr, std::size_t capacity = std::size_t(1) << 16)
+            : out(out), data(capacity) {}
+
+    writer(const writer &) = delete;
+
+    writer &operator=(const writer &) = delete;
+
+    ~writer() { flush(); }
+
+    writer &operator<<(char c) {
+        *room(1) = c;
+        return *this;
+    }
+
+    writer &operator<<(const char *s) { return write(s, std::strlen(s)); }
+
+    writer &operator<<(const std::string &s) { return write(s.data(), s.size()); }
+
+    // decimal, __int128 included
+    template<typename V>
+    std::enable_if_t<std::is_integral<V>::value || std::is_same<V, __int128>::value, writer &> operator<<(V v) {
+        char digits[40];
+        auto p(digits + sizeof(digits));
+        const bool negative(v < 0);
+        do {
+            const auto d(v % 10);
+            *--p = "0123456789"[static_cast<int>(negative ? -d : d)];
+            v /= 10;
+        } while (v);
+        if (negative) {
+            *--p = '-';
+        }
+        return write(p, digits + sizeof(digits) - p);
+    }
+
+    writer &write(const char *s, std::size_t k) {
+        std::memcpy(room(k), s, k);
+        return *this;
+    }
+
+    // the first `count` characters of a bit line, the high bits of v
+    void bits(word v, std::size_t count, BITS form) {
+        if (form == BITS::HEX) {
+            auto p(room((count + 3) / 4));
+            for (std::size_t i(0); i < count; i += 4) {
+                *p++ = "0123456789abcdef"[(v >> (60 - i)) & 15];
+            }
+            return;
+        }
+        if (form == BITS::RAW) {
+            auto p(room((count + 7) / 8));
+            for (std::size_t i(0); i < count; i += 8) {
+                *p++ = static_cast<char>(v >> (56 - i));
+            }
+            return;
+        }
+        auto p(room(count));
+        for (std::size_t i(0); i < count; i += 8) {
+            const word x(expand(static_cast<unsigned>(v >> (56 - i)) & 255));
+            std::memcpy(p + i, &x, std::min<std::size_t>(8, count - i));
+        }
+    }
+
+    // bits [0, count) of w (count <= 64) negated, in the given order
+    void negated(word w, std::size_t count, ORDER order, BITS form) {
+        const auto v(order == ORDER::DIRECT ? reverse_bits(~w) : ~w << (64 - count));
+        bits(count < 64 ? v & ~(~word(0) >> count) : v, count, form);
+    }
+
+    // the first `size` bits of t, negated, from bit 0 up (DIRECT) or from bit
+    // size - 1 down (INVERSE); words past the end of t are zero
+    template<typename T>
+    void space(const T &t, std::size_t size, ORDER order, BITS form) {
+        const auto count(std::min<std::size_t>(64, size));
+        const auto words((size + 63) / 64);
+        auto at = [&](std::size_t i) { return i < t.size() ? t[i] : word(0); };
+        if (order == ORDER::DIRECT) {
+            for (std::size_t i(0); i < words; i++) {
+                negated(at(i), count, order, form);
+            }
+        } else {
+            for (auto i(words); i-- > 0;) {
+                negated(at(i), count, order, form);
+            }
+        }
+    }
+
+    void flush() {
+        if (out && used) {
+            out->write(data.data(), used);
+            used = 0;
+        }
+        if (out) {
+            out->flush();
+        }
+    }
+
+    std::string take() {
+        std::string text(data.data(), used);
+        used = 0;
+        return text;
+    }
+
+private:
+    static word expand(unsigned b) {
+#ifdef __BMI2__
+        return __builtin_bswap64(_pdep_u64(b, 0x0101010101010101ull)) + 0x3030303030303030ull;
+#else
+        return bit_chars()[b];
+#endif
+    }
+
+    // k bytes at the end of the buffer, written through before it overflows
+    char *room(std::size_t k) {
+        if (used + k > data.size()) {
+            if (out && used) {
+                out->write(data.data(), used);
+                used = 0;
+            }
+            if (used + k > data.size()) {
+                data.resize(std::max(used + k, 2 * data.size()));
+            }
+        }
+        auto p(data.data() + used);
+        used += k;
+        return p;
+    }
+
+    std::ostream *out;
+    std::vector<char> data;
+    std::size_t used = 0;
+};
+
+class record {
+public:
+    record(writer &out, FORMAT format, BITS form) : out(out), format(format), form(format == FORMAT::JSON && form == BITS::RAW ? BITS::HEX : form) {}
+
+    bool json() const { return format == FORMAT::JSON; }
+
+    // name: the key of the header in JSON
+    void begin(const std::string &example, const char *name = "example") {
+        if (json()) {
+            out << "{\"" << name << "\":";
+            quote(example);
+        } else {
+            out << "EXAMPLE " << example << '\n';
+            rule('=');
+        }
+    }
+
+    // opens the field `name` (the line `label` in text); its value follows
+    writer &key(const char *label, const char *name) {
+        close();
+        if (json()) {
+            out << ",\"" << name << "\":";
+        } else {
+            const auto k(std::strlen(label));
+            out << label << std::string(k < 16 ? 16 - k : 0, ' ') << ": ";
+            open = true;
+        }
+        last = name;
+        return out;
+    }
+
+    // the next element of the array `name`, a line of its own in text
+    writer &item(const char *label, const char *name) {
+        if (json() && listing && !std::strcmp(last, name)) {
+            if (items++) {
+                out << ',';
+            }
+            return out;
+        }
+        key(label, name);
+        if (json()) {
+            out << '[';
+            listing = true;
+            items = 1;
+        }
+        return out;
+    }
+
+    template<typename V>
+    void item(const char *label, const char *name, const V &v) {
+        item(label, name);
+        put(v);
+    }
+
+    // a value, with its unit in text
+    template<typename V>
+    void field(const char *label, const char *name, const V &v, const char *unit = "") {
+        key(label, name);
+        put(v);
+        if (!json()) {
+            out << unit;
+        }
+    }
+
+    // a bit line, whose body emit(out, form) writes
+    template<typename F>
+    void space(const char *label, const char *name, F &&emit) {
+        key(label, name);
+        if (json()) {
+            out << '"';
+        }
+        emit(out, form);
+        if (json()) {
+            out << '"';
+        }
+    }
+
+    // the first `size` bits of t, negated
+    template<typename T>
+    void space(const char *label, const char *name, const T &t, std::size_t size, ORDER order) {
+        space(label, name, [&](writer &o, BITS f) { o.space(t, size, order, f); });
+    }
+
+    // an assignment as DIMACS literals (bit n - v of x set: v false); ~0 is
+    // UNSAT in text and no element in JSON
+    void model(const char *label, const char *name, word x, const std::size_t &n) {
+        if (x == ~word(0)) {
+            if (!json()) {
+                key(label, name) << "UNSAT";
+            } else if (!listing || std::strcmp(last, name)) {
+                key(label, name) << '[';
+                listing = true;
+                items = 0;
+            }
+            return;
+        }
+        item(label, name);
+        if (json()) {
+            out << '[';
+        }
+        for (std::size_t v(1); v <= n; v++) {
+            if (v > 1) {
+                out << (json() ? ',' : ' ');
+            }
+            if ((x >> (n - v)) & 1) {
+                out << '-';
+            }
+            out << v;
+        }
+        if (json()) {
+            out << ']';
+        }
+    }
+
+    void end() {
+        close();
+        if (json()) {
+            out << "}\n";
+        } else {
+            rule('-');
+        }
+    }
+
+private:
+    void rule(char c) {
+        char line[186];
+        std::memset(line, c, 185);
+        line[185] = '\n';
+        out.write(line, sizeof(line));
+    }
+
+    void close() {
+        if (open) {
+            out << '\n';
+            open = false;
+        }
+        if (listing) {
+            out << ']';
+            listing = false;
+        }
+    }
+
+    void put(const std::string &s) {
+        if (json()) {
+            quote(s);
+        } else {
+            out << s;
+        }
+    }
+
+    void put(const char *s) { put(std::string(s)); }
+
+    template<typename V>
+    void put(const V &v) { out << v; }
+
+    void quote(const std::string &s) {
+        out << '"';
+        for (const auto c : s) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 15];
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    writer &out;
+    FORMAT format;
+    BITS form;
+    const char *last = "";
+    bool open = false;
+    bool listing = false;
+    std::size_t items = 0;
+};
+
+#endif